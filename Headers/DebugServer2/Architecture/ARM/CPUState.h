@@ -77,8 +77,10 @@ struct CPUState {
     uint32_t wp_addr[32];
   } hbp;
 
+  uint32_t validSets; // kRegisterSet* values
+
 public:
-  CPUState() { clear(); }
+  CPUState() : validSets(kRegisterSetAll) { clear(); }
 
   inline void clear() {
     std::memset(&gp, 0, sizeof(gp));
@@ -101,10 +103,21 @@ public:
   inline uint32_t sp() const { return gp.sp; }
   inline void setSP(uint32_t sp) { gp.sp = sp; }
 
+  //
+  // Thumb code uses r7 as the frame pointer, ARM code uses r11
+  //
+  inline uint32_t fp() const { return isThumb() ? gp.r7 : gp.r11; }
+
   inline uint32_t retval() const { return gp.r0; }
 
   inline bool isThumb() const { return (gp.cpsr & (1 << 5)) != 0; }
 
+public:
+  // Register sets holding the register that get*RegisterPtr returned.
+  inline uint32_t registerSetsOf(void const *ptr, size_t length) const {
+    return (ptr >= &vfp && ptr < &hbp) ? kRegisterSetFP : kRegisterSetGP;
+  }
+
 public:
   inline void getGPState(GPRegisterValueVector &regs) const {
     regs.clear();
@@ -36,6 +36,10 @@ public:
 public:
   virtual bool has(Address const &address) const override;
 
+public:
+  virtual void restoreInstructions(Address const &address, void *buffer,
+                                   size_t length) const override;
+
 public:
   virtual void
   enumerate(std::function<void(Site const &)> const &cb) const override;
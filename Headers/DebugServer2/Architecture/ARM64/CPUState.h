@@ -62,8 +62,16 @@ struct CPUState64 {
   inline uint64_t sp() const { return gp.sp; }
   inline void setSP(uint64_t sp) { gp.sp = sp; }
 
+  inline uint64_t fp() const { return gp.fp; }
+
   inline uint64_t retval() const { return gp.x0; }
 
+public:
+  // Register sets holding the register that get*RegisterPtr returned.
+  inline uint32_t registerSetsOf(void const *ptr, size_t length) const {
+    return (ptr >= &vfp && ptr < &vfp + 1) ? kRegisterSetFP : kRegisterSetGP;
+  }
+
 public:
   inline void getGPState(GPRegisterValueVector &regs) const {
     regs.clear();
@@ -146,7 +154,9 @@ struct CPUState {
     CPUState64 state64;
   };
 
-  CPUState() : state64() {}
+  uint32_t validSets; // kRegisterSet* values
+
+  CPUState() : state64(), validSets(kRegisterSetAll) {}
 
   //
   // Accessors
@@ -171,12 +181,22 @@ struct CPUState {
       state64.setSP(sp);
   }
 
+  inline uint64_t fp() const {
+    return isA32 ? static_cast<uint64_t>(state32.fp()) : state64.fp();
+  }
+
   inline uint64_t retval() const {
     return isA32 ? static_cast<uint64_t>(state32.retval()) : state64.retval();
   }
 
   inline bool isThumb() const { return isA32 ? state32.isThumb() : false; }
 
+public:
+  inline uint32_t registerSetsOf(void const *ptr, size_t length) const {
+    return isA32 ? state32.registerSetsOf(ptr, length)
+                 : state64.registerSetsOf(ptr, length);
+  }
+
 public:
   inline void getGPState(GPRegisterValueVector &regs) const {
     if (isA32) {
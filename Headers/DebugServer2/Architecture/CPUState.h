@@ -13,6 +13,24 @@
 
 #include "DebugServer2/Types.h"
 
+namespace ds2 {
+namespace Architecture {
+
+//
+// Groups of registers that are transferred to and from the target
+// independently. The validSets field of CPUState tells which of them hold
+// actual values; targets that can't transfer them separately always fill
+// every set.
+//
+enum RegisterSet {
+  kRegisterSetGP = (1 << 0),  // General purpose registers
+  kRegisterSetFP = (1 << 1),  // Floating point and vector registers
+  kRegisterSetAVX = (1 << 2), // Upper halves of the x86 AVX registers
+  kRegisterSetAll = kRegisterSetGP | kRegisterSetFP | kRegisterSetAVX
+};
+}
+}
+
 #if defined(ARCH_ARM)
 #include "DebugServer2/Architecture/ARM/CPUState.h"
 #elif defined(ARCH_ARM64)
@@ -156,9 +156,24 @@ struct GDBDescriptor {
   GDBFeature const *const *Features;
 };
 
+struct LLDBRegisterInfo {
+  char const *SetName;
+  RegisterDef const *Def;
+};
+
 struct LLDBDescriptor {
   size_t Count;
   LLDBRegisterSet const *const *Sets;
+  // Flat tables generated along with the sets: registers in the order of
+  // the sets, which is the index qRegisterInfo uses, and a minimal perfect
+  // hash of their names, where NameSeeds selects the seed that maps a name to
+  // its slot in NameSlots, which holds an index into Registers.
+  size_t RegisterCount;
+  LLDBRegisterInfo const *Registers;
+  size_t NameSeedCount;
+  uint32_t const *NameSeeds;
+  size_t NameSlotCount;
+  int32_t const *NameSlots;
 };
 
 //
@@ -196,10 +211,17 @@ std::string LLDBGenerateXMLMain(LLDBDescriptor const &lldbDesc);
 // LLDB Register Information Functions
 //
 
-struct LLDBRegisterInfo {
-  char const *SetName;
-  RegisterDef const *Def;
-};
+// FNV-1a hash of a register name, used to look names up in the tables
+// RegsGen2 generates; it must match the one in Tools/RegsGen2.
+static inline uint32_t RegisterNameHash(char const *name, size_t length,
+                                        uint32_t seed) {
+  uint32_t hash = 2166136261u ^ seed;
+  for (size_t n = 0; n < length; n++) {
+    hash ^= static_cast<uint8_t>(name[n]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
 
 bool LLDBGetRegisterInfo(LLDBDescriptor const &desc, size_t index,
                          LLDBRegisterInfo &info);
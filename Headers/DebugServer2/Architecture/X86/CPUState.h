@@ -33,6 +33,12 @@ struct AVXVector {
   uint64_t value[4]; // 256-bit values
 };
 
+struct XSaveLayout {
+  uint32_t size;      // Size of the area, 0 if it wasn't available
+  uint64_t xfeatures; // State components present in the area
+  uint64_t xcr0;      // State components enabled by the kernel
+};
+
 struct X87Register {
   union {
 #if !defined(OS_WIN32)
@@ -92,7 +98,9 @@ struct CPUState {
     } avx;
   };
 
-  // TODO - add information about xstate_hdr here
+  // Layout of the XSAVE area the registers above were read from, so that
+  // it can be rebuilt when writing them back.
+  XSaveLayout xsave;
 
   struct {
     uint32_t dr[8];
@@ -104,13 +112,22 @@ struct CPUState {
   } linux_gp;
 #endif
 
+  uint32_t validSets; // kRegisterSet* values
+
+#if defined(ARCH_X86)
+  // The XSAVE area itself, including the components we don't carry
+  // (AVX-512, PKRU, ...). X86_64::CPUState keeps it outside of its union.
+  ByteVector xsaveArea;
+#endif
+
 public:
-  CPUState() { clear(); }
+  CPUState() : validSets(kRegisterSetAll) { clear(); }
 
   inline void clear() {
     std::memset(&gp, 0, sizeof(gp));
     std::memset(&x87, 0, sizeof(x87));
     std::memset(&avx, 0, sizeof(avx));
+    std::memset(&xsave, 0, sizeof(xsave));
     std::memset(&dr, 0, sizeof(dr));
 #if defined(OS_LINUX)
     std::memset(&linux_gp, 0, sizeof(linux_gp));
@@ -129,8 +146,23 @@ public:
   inline uint32_t sp() const { return gp.esp; }
   inline void setSP(uint32_t sp) { gp.esp = sp; }
 
+  inline uint32_t fp() const { return gp.ebp; }
+
   inline uint32_t retval() const { return gp.eax; }
 
+public:
+  // Register sets holding the register that get*RegisterPtr returned.
+  inline uint32_t registerSetsOf(void const *ptr, size_t length) const {
+    if (ptr < &x87 || ptr >= &dr)
+      return kRegisterSetGP;
+
+    // AVX registers overlap their SSE counterpart.
+    if (length > sizeof(SSEVector))
+      return kRegisterSetFP | kRegisterSetAVX;
+
+    return kRegisterSetFP;
+  }
+
 public:
 #define _REGVALUE(REG)                                                         \
   GPRegisterValue { sizeof(gp.REG), gp.REG }
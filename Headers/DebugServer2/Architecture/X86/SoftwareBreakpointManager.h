@@ -31,6 +31,10 @@ public:
 public:
   void clear() override;
 
+public:
+  void restoreInstructions(Address const &address, void *buffer,
+                           size_t length) const override;
+
 protected:
   ErrorCode enableLocation(Site const &site) override;
   ErrorCode disableLocation(Site const &site) override;
@@ -30,6 +30,7 @@ namespace X86_64 {
 using ds2::Architecture::X86::X87Register;
 using ds2::Architecture::X86::SSEVector;
 using ds2::Architecture::X86::AVXVector;
+using ds2::Architecture::X86::XSaveLayout;
 
 struct EAVXVector {
   uint64_t value[8]; // 512-bit values
@@ -132,7 +133,9 @@ struct CPUState64 {
     } eavx;
   };
 
-  // TODO - add information about xstate_hdr here
+  // Layout of the XSAVE area the registers above were read from, so that
+  // it can be rebuilt when writing them back.
+  XSaveLayout xsave;
 
   struct {
     uint32_t dr[8];
@@ -153,6 +156,7 @@ public:
     std::memset(&gp, 0, sizeof(gp));
     std::memset(&x87, 0, sizeof(x87));
     std::memset(&eavx, 0, sizeof(eavx));
+    std::memset(&xsave, 0, sizeof(xsave));
     std::memset(&dr, 0, sizeof(dr));
 #if defined(OS_LINUX)
     std::memset(&linux_gp, 0, sizeof(linux_gp));
@@ -169,8 +173,23 @@ public:
   inline uint64_t sp() const { return gp.rsp; }
   inline void setSP(uint64_t sp) { gp.rsp = sp; }
 
+  inline uint64_t fp() const { return gp.rbp; }
+
   inline uint64_t retval() const { return gp.rax; }
 
+public:
+  // Register sets holding the register that get*RegisterPtr returned.
+  inline uint32_t registerSetsOf(void const *ptr, size_t length) const {
+    if (ptr < &x87 || ptr >= &dr)
+      return kRegisterSetGP;
+
+    // AVX registers overlap their SSE counterpart.
+    if (length > sizeof(SSEVector))
+      return kRegisterSetFP | kRegisterSetAVX;
+
+    return kRegisterSetFP;
+  }
+
 public:
 #define _REGVALUE(REG)                                                         \
   GPRegisterValue { sizeof(gp.REG), gp.REG }
@@ -450,22 +469,22 @@ public:
       _GETREG2(avx, ymm14, regs[14]);
       _GETREG2(avx, ymm15, regs[15]);
 
-      _GETREG2(sse, xmm0, regs[16]);
-      _GETREG2(sse, xmm1, regs[17]);
-      _GETREG2(sse, xmm2, regs[18]);
-      _GETREG2(sse, xmm3, regs[19]);
-      _GETREG2(sse, xmm4, regs[20]);
-      _GETREG2(sse, xmm5, regs[21]);
-      _GETREG2(sse, xmm6, regs[22]);
-      _GETREG2(sse, xmm7, regs[23]);
-      _GETREG2(sse, xmm8, regs[24]);
-      _GETREG2(sse, xmm9, regs[25]);
-      _GETREG2(sse, xmm10, regs[26]);
-      _GETREG2(sse, xmm11, regs[27]);
-      _GETREG2(sse, xmm12, regs[28]);
-      _GETREG2(sse, xmm13, regs[29]);
-      _GETREG2(sse, xmm14, regs[30]);
-      _GETREG2(sse, xmm15, regs[31]);
+      _GETREG2(sse, xmm0, regs[0]);
+      _GETREG2(sse, xmm1, regs[1]);
+      _GETREG2(sse, xmm2, regs[2]);
+      _GETREG2(sse, xmm3, regs[3]);
+      _GETREG2(sse, xmm4, regs[4]);
+      _GETREG2(sse, xmm5, regs[5]);
+      _GETREG2(sse, xmm6, regs[6]);
+      _GETREG2(sse, xmm7, regs[7]);
+      _GETREG2(sse, xmm8, regs[8]);
+      _GETREG2(sse, xmm9, regs[9]);
+      _GETREG2(sse, xmm10, regs[10]);
+      _GETREG2(sse, xmm11, regs[11]);
+      _GETREG2(sse, xmm12, regs[12]);
+      _GETREG2(sse, xmm13, regs[13]);
+      _GETREG2(sse, xmm14, regs[14]);
+      _GETREG2(sse, xmm15, regs[15]);
 
     default:
       return false;
@@ -576,7 +595,13 @@ struct CPUState {
     CPUState64 state64;
   };
 
-  CPUState() : state64() {}
+  uint32_t validSets; // kRegisterSet* values
+
+  // The XSAVE area itself, including the components we don't carry
+  // (AVX-512, PKRU, ...).
+  ByteVector xsaveArea;
+
+  CPUState() : state64(), validSets(kRegisterSetAll) {}
 
   //
   // Accessors
@@ -601,10 +626,20 @@ struct CPUState {
       state64.setSP(sp);
   }
 
+  inline uint64_t fp() const {
+    return is32 ? static_cast<uint64_t>(state32.fp()) : state64.fp();
+  }
+
   inline uint64_t retval() const {
     return is32 ? static_cast<uint64_t>(state32.retval()) : state64.retval();
   }
 
+public:
+  inline uint32_t registerSetsOf(void const *ptr, size_t length) const {
+    return is32 ? state32.registerSetsOf(ptr, length)
+                : state64.registerSetsOf(ptr, length);
+  }
+
 public:
   inline void getGPState(GPRegisterValueVector &regs) const {
     if (is32) {
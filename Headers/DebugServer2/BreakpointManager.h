@@ -77,6 +77,16 @@ public:
 public:
   virtual bool has(Address const &address) const;
 
+public:
+  inline bool enabled() const { return _enabled; }
+
+public:
+  // Puts the instructions that breakpoints replaced back in |buffer|, which
+  // holds |length| bytes of memory read at |address|, so that the debugger
+  // doesn't see breakpoints inserted while some threads run.
+  virtual void restoreInstructions(Address const &address, void *buffer,
+                                   size_t length) const {}
+
 public:
   virtual void enumerate(std::function<void(Site const &)> const &cb) const;
 
@@ -18,7 +18,10 @@
 #include "DebugServer2/Target/Thread.h"
 #include "DebugServer2/Utils/MPL.h"
 
+#include <atomic>
+#include <deque>
 #include <mutex>
+#include <thread>
 
 namespace ds2 {
 namespace GDBRemote {
@@ -34,11 +37,53 @@ protected:
   // a struct to help iterate over the thread list for onQueryThreadList
   mutable IterationState<ThreadId> _threadIterationState;
 
+protected:
+  // What we know of the threads at the current stop, collected once and
+  // shared by stop replies, qThreadStopInfo, jThreadsInfo and qXfer:threads.
+  // Registers are left out, threads cache them and they can be written to.
+  struct StopSnapshot {
+    bool valid;
+    uint32_t stopGeneration;
+    std::set<ThreadId> threads;
+    std::map<ThreadId, StopInfo> stops;
+  };
+  mutable StopSnapshot _stopSnapshot;
+
+protected:
+  // Location in CPUState of the registers sent in stop replies, computed
+  // once for what the debugger negotiated rather than at every stop.
+  struct ExpeditedRegister {
+    size_t regno;
+    size_t offset;
+    size_t size;
+  };
+  mutable std::vector<ExpeditedRegister> _expeditedRegisters;
+  mutable bool _expeditedRegistersValid;
+
+protected:
+  // qXfer documents generated at the current stop, indexed by object and
+  // annex; see onXferRead.
+  std::map<std::string, std::string> _xferDocuments;
+  uint32_t _xferStopGeneration;
+  size_t _xferDocumentsSize;
+
 protected:
   std::mutex _resumeSessionLock;
   Session *_resumeSession;
   std::string _consoleBuffer;
 
+protected:
+  // Also read by the thread forwarding the inferior output.
+  std::atomic<bool> _nonStop;
+  // Threads stopped on request in non-stop mode, not reported yet.
+  std::deque<ThreadId> _stoppedThreads;
+  // In non-stop mode, the session is woken up to collect the inferior output
+  // and the thread stops, see waitForEvents.
+  std::mutex _nonStopLock;
+  Session *_nonStopSession;
+  std::deque<std::string> _pendingOutput;
+  std::thread _eventThread;
+
 public:
   DebugSessionImplBase(StringCollection const &args,
                        EnvironmentBlock const &env);
@@ -61,6 +106,7 @@ protected:
   ErrorCode onProgramSignals(Session &session,
                              std::vector<int> const &signals) override;
   ErrorCode onNonStopMode(Session &session, bool enable) override;
+  ErrorCode onEnableDirtyPageTracking(Session &session, bool enable) override;
   ErrorCode onSendInput(Session &session, ByteVector const &buf) override;
 
 protected:
@@ -87,6 +133,8 @@ protected:
 protected:
   ErrorCode onQueryRegisterInfo(Session &session, uint32_t regno,
                                 RegisterInfo &info) const override;
+  ErrorCode onQueryResponseScope(Session &session, ResponseScope scope,
+                                 std::string &key) const override;
 
 protected:
   ErrorCode onQuerySharedLibrariesInfoAddress(Session &session,
@@ -97,6 +145,8 @@ protected:
                        std::string const &annex, uint64_t offset,
                        uint64_t length, std::string &buffer,
                        bool &last) override;
+  ErrorCode generateXferDocument(Session &session, std::string const &object,
+                                 std::string const &annex, std::string &buffer);
 
 protected:
   ErrorCode onSetStdFile(Session &session, int fileno,
@@ -110,6 +160,11 @@ protected:
                                     ProcessThreadId const &ptid,
                                     std::vector<uint64_t> const &regs) override;
 
+  ErrorCode onReadAllRegisters(Session &session, ProcessThreadId const &ptid,
+                               ByteVector &context) override;
+  ErrorCode onWriteAllRegisters(Session &session, ProcessThreadId const &ptid,
+                                ByteVector const &context) override;
+
   ErrorCode onSaveRegisters(Session &session, ProcessThreadId const &ptid,
                             uint64_t &id) override;
   ErrorCode onRestoreRegisters(Session &session, ProcessThreadId const &ptid,
@@ -124,6 +179,13 @@ protected:
 protected:
   ErrorCode onReadMemory(Session &session, Address const &address,
                          size_t length, ByteVector &data) override;
+  ErrorCode
+  onReadMemoryRanges(Session &session,
+                     std::vector<std::pair<Address, size_t>> const &ranges,
+                     std::vector<ByteVector> &data) override;
+  ErrorCode onQueryDirtyPages(Session &session, Address const &address,
+                              size_t length, size_t &pageSize,
+                              std::vector<bool> &dirty) override;
   ErrorCode onWriteMemory(Session &session, Address const &address,
                           ByteVector const &data, size_t &nwritten) override;
 
@@ -135,6 +197,15 @@ protected:
   ErrorCode onQueryMemoryRegionInfo(Session &session, Address const &address,
                                     MemoryRegionInfo &info) const override;
 
+  ErrorCode onComputeCRC(Session &session, Address const &address,
+                         size_t length, uint32_t &crc) override;
+
+  ErrorCode onSearch(Session &session, Address const &address, size_t length,
+                     std::string const &pattern, Address &location) override;
+  ErrorCode onSearchBackward(Session &session, Address const &address,
+                             uint32_t pattern, uint32_t mask,
+                             Address &location) override;
+
 protected:
   ErrorCode onSetEnvironmentVariable(Session &session, std::string const &name,
                                      std::string const &value) override;
@@ -151,6 +222,8 @@ protected:
   ErrorCode onResume(Session &session,
                      ThreadResumeAction::Collection const &actions,
                      StopInfo &stop) override;
+  ErrorCode onQueryStopEvent(Session &session, StopInfo &stop) override;
+  ErrorCode onQueryOutput(Session &session, std::string &output) override;
   ErrorCode onTerminate(Session &session, ProcessThreadId const &ptid,
                         StopInfo &stop) override;
   ErrorCode onDetach(Session &session, ProcessId pid, bool stopped) override;
@@ -167,10 +240,19 @@ protected:
 
 protected:
   Target::Thread *findThread(ProcessThreadId const &ptid) const;
+  void updateStopSnapshot() const;
+  StopInfo const &snapshotStopInfo(Target::Thread *thread) const;
+  ErrorCode readStopInfo(Session &session, Target::Thread *thread,
+                         StopInfo &stop) const;
   ErrorCode queryStopInfo(Session &session, Target::Thread *thread,
                           StopInfo &stop) const;
   ErrorCode queryStopInfo(Session &session, ProcessThreadId const &ptid,
                           StopInfo &stop) const;
+  void readExpeditedRegisters(Session &session,
+                              Architecture::CPUState const &state,
+                              Architecture::GPRegisterStopMap &regs) const;
+  void readExpeditedMemory(Architecture::CPUState const &state, size_t size,
+                           std::map<uint64_t, ByteVector> &memory) const;
 
 protected:
   ErrorCode fetchStopInfoForAllThreads(Session &session,
@@ -179,10 +261,18 @@ protected:
   ErrorCode createThreadsStopInfo(Session &session,
                                   JSArray &threadsStopInfo) override;
 
+private:
+  ErrorCode resumeThreads(ThreadResumeAction::Collection const &actions);
+
 private:
   ErrorCode spawnProcess(StringCollection const &args,
                          EnvironmentBlock const &env);
   void appendOutput(char const *buf, size_t size);
+
+private:
+  void startWaitingForEvents(Session &session);
+  void stopWaitingForEvents();
+  void waitForEvents();
 };
 
 using DebugSessionImpl =
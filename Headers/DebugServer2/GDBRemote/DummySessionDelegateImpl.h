@@ -51,6 +51,8 @@ protected: // Common
   ErrorCode onQueryServerVersion(Session &session,
                                  ServerVersion &version) const override;
   ErrorCode onQueryHostInfo(Session &session, HostInfo &info) const override;
+  ErrorCode onQueryResponseScope(Session &session, ResponseScope scope,
+                                 std::string &key) const override;
   ErrorCode onQueryFileLoadAddress(Session &session,
                                    std::string const &file_path,
                                    Address &address) override;
@@ -59,6 +61,7 @@ protected: // Debugging Session
   ErrorCode onEnableControlAgent(Session &session, bool enable) override;
   ErrorCode onNonStopMode(Session &session, bool enable) override;
   ErrorCode onEnableBTSTracing(Session &session, bool enable) override;
+  ErrorCode onEnableDirtyPageTracking(Session &session, bool enable) override;
 
   ErrorCode onPassSignals(Session &session,
                           std::vector<int> const &signals) override;
@@ -139,6 +142,8 @@ protected: // Debugging Session
   ErrorCode onResume(Session &session,
                      ThreadResumeAction::Collection const &actions,
                      StopInfo &stop) override;
+  ErrorCode onQueryStopEvent(Session &session, StopInfo &stop) override;
+  ErrorCode onQueryOutput(Session &session, std::string &output) override;
 
   ErrorCode
   onReadGeneralRegisters(Session &session, ProcessThreadId const &ptid,
@@ -147,6 +152,11 @@ protected: // Debugging Session
                                     ProcessThreadId const &ptid,
                                     std::vector<uint64_t> const &regs) override;
 
+  ErrorCode onReadAllRegisters(Session &session, ProcessThreadId const &ptid,
+                               ByteVector &context) override;
+  ErrorCode onWriteAllRegisters(Session &session, ProcessThreadId const &ptid,
+                                ByteVector const &context) override;
+
   ErrorCode onSaveRegisters(Session &session, ProcessThreadId const &ptid,
                             uint64_t &id) override;
   ErrorCode onRestoreRegisters(Session &session, ProcessThreadId const &ptid,
@@ -160,6 +170,13 @@ protected: // Debugging Session
 
   ErrorCode onReadMemory(Session &session, Address const &address,
                          size_t length, ByteVector &data) override;
+  ErrorCode
+  onReadMemoryRanges(Session &session,
+                     std::vector<std::pair<Address, size_t>> const &ranges,
+                     std::vector<ByteVector> &data) override;
+  ErrorCode onQueryDirtyPages(Session &session, Address const &address,
+                              size_t length, size_t &pageSize,
+                              std::vector<bool> &dirty) override;
   ErrorCode onWriteMemory(Session &session, Address const &address,
                           ByteVector const &data, size_t &nwritten) override;
 
@@ -173,7 +190,7 @@ protected: // Debugging Session
   ErrorCode onComputeCRC(Session &session, Address const &address,
                          size_t length, uint32_t &crc) override;
 
-  ErrorCode onSearch(Session &session, Address const &address,
+  ErrorCode onSearch(Session &session, Address const &address, size_t length,
                      std::string const &pattern, Address &location) override;
   ErrorCode onSearchBackward(Session &session, Address const &address,
                              uint32_t pattern, uint32_t mask,
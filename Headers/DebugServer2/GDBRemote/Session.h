@@ -14,19 +14,54 @@
 #include "DebugServer2/GDBRemote/ProtocolInterpreter.h"
 #include "DebugServer2/GDBRemote/SessionBase.h"
 
+#include <deque>
 #include <functional>
 #include <map>
+#include <set>
 
 namespace ds2 {
 namespace GDBRemote {
 
 class Session : public SessionBase {
+public:
+  enum ExpeditedRegisters {
+    kExpediteAllRegisters,     // Every general purpose register
+    kExpediteGenericRegisters, // PC, SP, FP and return address only
+    kExpediteListedRegisters,  // The registers the debugger asked for
+  };
+
 protected:
   std::map<char, ProcessThreadId> _ptids;
   bool _threadsInStopReply;
+  size_t _expeditedMemorySize;
+  ExpeditedRegisters _expeditedRegisters;
+  std::set<uint32_t> _expeditedRegisterList;
+  bool _binaryRegisters;
+  bool _nonStopMode;
+  std::deque<StopInfo> _pendingStops;
+  std::deque<std::string> _pendingOutput;
 
 public:
   Session(CompatibilityMode mode);
+  ~Session() override;
+
+public:
+  inline bool threadsInStopReply() const { return _threadsInStopReply; }
+  inline size_t expeditedMemorySize() const { return _expeditedMemorySize; }
+  inline ExpeditedRegisters expeditedRegisters() const {
+    return _expeditedRegisters;
+  }
+  inline std::set<uint32_t> const &expeditedRegisterList() const {
+    return _expeditedRegisterList;
+  }
+  inline bool binaryRegisters() const { return _binaryRegisters; }
+  inline bool nonStopMode() const { return _nonStopMode; }
+
+protected:
+  void onIdle() override;
+
+private:
+  void sendResumeReply(StopInfo const &stop);
 
 private:
   void Handle_ControlC(ProtocolInterpreter::Handler const &,
@@ -59,12 +94,16 @@ private:
   void Handle__m(ProtocolInterpreter::Handler const &, std::string const &);
   void Handle_M(ProtocolInterpreter::Handler const &, std::string const &);
   void Handle_m(ProtocolInterpreter::Handler const &, std::string const &);
+  void Handle_MultiMemRead(ProtocolInterpreter::Handler const &,
+                           std::string const &);
   void Handle_P(ProtocolInterpreter::Handler const &, std::string const &);
   void Handle_p(ProtocolInterpreter::Handler const &, std::string const &);
   void Handle_QAgent(ProtocolInterpreter::Handler const &, std::string const &);
   void Handle_QAllow(ProtocolInterpreter::Handler const &, std::string const &);
   void Handle_Qbtrace(ProtocolInterpreter::Handler const &,
                       std::string const &);
+  void Handle_QDirtyPageTracking(ProtocolInterpreter::Handler const &,
+                                 std::string const &);
   void Handle_QDisableRandomization(ProtocolInterpreter::Handler const &,
                                     std::string const &);
   void Handle_QEnvironment(ProtocolInterpreter::Handler const &,
@@ -113,6 +152,8 @@ private:
                         std::string const &);
   void Handle_qC(ProtocolInterpreter::Handler const &, std::string const &);
   void Handle_qCRC(ProtocolInterpreter::Handler const &, std::string const &);
+  void Handle_qDirtyPages(ProtocolInterpreter::Handler const &,
+                          std::string const &);
   void Handle_qFileLoadAddress(ProtocolInterpreter::Handler const &,
                                std::string const &);
   void Handle_qGDBServerVersion(ProtocolInterpreter::Handler const &,
@@ -140,6 +181,8 @@ private:
                              std::string const &);
   void Handle_qMemoryRegionInfo(ProtocolInterpreter::Handler const &,
                                 std::string const &);
+  void Handle_qMemoryRegions(ProtocolInterpreter::Handler const &,
+                             std::string const &);
   void Handle_qModuleInfo(ProtocolInterpreter::Handler const &,
                           std::string const &);
   void Handle_qOffsets(ProtocolInterpreter::Handler const &,
@@ -220,6 +263,7 @@ private:
                           std::string const &);
   void Handle_vKill(ProtocolInterpreter::Handler const &, std::string const &);
   void Handle_vRun(ProtocolInterpreter::Handler const &, std::string const &);
+  void Handle_vStdio(ProtocolInterpreter::Handler const &, std::string const &);
   void Handle_vStopped(ProtocolInterpreter::Handler const &,
                        std::string const &);
   void Handle_X(ProtocolInterpreter::Handler const &, std::string const &);
@@ -227,6 +271,14 @@ private:
   void Handle_Z(ProtocolInterpreter::Handler const &, std::string const &);
   void Handle_z(ProtocolInterpreter::Handler const &, std::string const &);
 
+private:
+  void sendThreadList(ThreadId lastTid);
+
+private:
+  void
+  sendCachedResponse(ResponseScope scope, std::string const &packet,
+                     std::function<ErrorCode(std::string &)> const &generate);
+
 private:
   static bool ParseList(std::string const &string, char separator,
                         std::function<void(std::string const &)> const &cb);
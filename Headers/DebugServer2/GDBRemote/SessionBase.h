@@ -62,17 +62,35 @@ public:
   bool receive(bool cooked);
   bool parse(std::string const &data);
 
+  // Makes receive call onIdle; can be called from any thread.
+  void wake() { _channel->wake(); }
+
+protected:
+  virtual void onIdle() {}
+
 public:
   bool send(char const *data, bool escaped = false) {
     return send(std::string(data), escaped);
   }
 
   template <typename T> bool send(T const &data, bool escaped = false) {
+    return sendPacket('$', data, escaped);
+  }
+
+  // Notifications are not replies to a packet, the debugger can get them at
+  // any time.
+  bool sendNotification(std::string const &name, std::string const &data) {
+    return sendPacket('%', name + ':' + data, false);
+  }
+
+private:
+  template <typename T>
+  bool sendPacket(char start, T const &data, bool escaped) {
     std::ostringstream ss;
     static std::string const searchStr = "$#}*";
     uint8_t csum;
 
-    ss << '$';
+    ss << start;
 
     //
     // If data contains $, #, } or * we need to escape the
@@ -54,6 +54,9 @@ protected: // Common
                                          ServerVersion &version) const = 0;
   virtual ErrorCode onQueryHostInfo(Session &session, HostInfo &info) const = 0;
 
+  virtual ErrorCode onQueryResponseScope(Session &session, ResponseScope scope,
+                                         std::string &key) const = 0;
+
   virtual ErrorCode onQueryFileLoadAddress(Session &session,
                                            std::string const &file_path,
                                            Address &address) = 0;
@@ -62,6 +65,8 @@ protected: // Debugging Session
   virtual ErrorCode onEnableControlAgent(Session &session, bool enable) = 0;
   virtual ErrorCode onNonStopMode(Session &session, bool enable) = 0;
   virtual ErrorCode onEnableBTSTracing(Session &session, bool enable) = 0;
+  virtual ErrorCode onEnableDirtyPageTracking(Session &session,
+                                              bool enable) = 0;
 
   virtual ErrorCode onPassSignals(Session &session,
                                   std::vector<int> const &signals) = 0;
@@ -152,6 +157,12 @@ protected: // Debugging Session
   virtual ErrorCode onResume(Session &session,
                              ThreadResumeAction::Collection const &actions,
                              StopInfo &stop) = 0;
+  // In non-stop mode, returns the next thread stop to report to the
+  // debugger, or kErrorNotFound if there is none yet.
+  virtual ErrorCode onQueryStopEvent(Session &session, StopInfo &stop) = 0;
+  // In non-stop mode, returns the next inferior output to forward to the
+  // debugger, or kErrorNotFound if there is none yet.
+  virtual ErrorCode onQueryOutput(Session &session, std::string &output) = 0;
 
   virtual ErrorCode
   onReadGeneralRegisters(Session &session, ProcessThreadId const &ptid,
@@ -160,6 +171,13 @@ protected: // Debugging Session
   onWriteGeneralRegisters(Session &session, ProcessThreadId const &ptid,
                           std::vector<uint64_t> const &regs) = 0;
 
+  virtual ErrorCode onReadAllRegisters(Session &session,
+                                       ProcessThreadId const &ptid,
+                                       ByteVector &context) = 0;
+  virtual ErrorCode onWriteAllRegisters(Session &session,
+                                        ProcessThreadId const &ptid,
+                                        ByteVector const &context) = 0;
+
   virtual ErrorCode onSaveRegisters(Session &session,
                                     ProcessThreadId const &ptid,
                                     uint64_t &id) = 0;
@@ -177,6 +195,13 @@ protected: // Debugging Session
 
   virtual ErrorCode onReadMemory(Session &session, Address const &address,
                                  size_t length, ByteVector &data) = 0;
+  virtual ErrorCode
+  onReadMemoryRanges(Session &session,
+                     std::vector<std::pair<Address, size_t>> const &ranges,
+                     std::vector<ByteVector> &data) = 0;
+  virtual ErrorCode onQueryDirtyPages(Session &session, Address const &address,
+                                      size_t length, size_t &pageSize,
+                                      std::vector<bool> &dirty) = 0;
   virtual ErrorCode onWriteMemory(Session &session, Address const &address,
                                   ByteVector const &data, size_t &nwritten) = 0;
 
@@ -193,7 +218,8 @@ protected: // Debugging Session
                                  size_t length, uint32_t &crc) = 0;
 
   virtual ErrorCode onSearch(Session &session, Address const &address,
-                             std::string const &pattern, Address &location) = 0;
+                             size_t length, std::string const &pattern,
+                             Address &location) = 0;
   virtual ErrorCode onSearchBackward(Session &session, Address const &address,
                                      uint32_t pattern, uint32_t mask,
                                      Address &location) = 0;
@@ -48,8 +48,15 @@ public:
   std::string threadName;
   Architecture::GPRegisterStopMap registers;
   std::set<ThreadId> threads;
+  // PC and stop state of every thread, sent along with the thread list so
+  // the debugger doesn't have to query each thread after a stop.
+  std::map<ThreadId, uint64_t> threadPCs;
+  std::map<ThreadId, ds2::StopInfo> threadStops;
   Address watchpointAddress;
   int watchpointIndex;
+  // Memory blocks sent along with the stop reply so the debugger doesn't
+  // have to fetch them, indexed by start address.
+  std::map<uint64_t, ByteVector> memory;
 
 public:
   std::string encode(CompatibilityMode mode, bool listThreads) const;
@@ -64,9 +71,9 @@ private:
   void reasonToString(std::string &key, std::string &val,
                       CompatibilityMode mode) const;
   std::string encodeInfo(CompatibilityMode mode, bool listThreads) const;
-  void encodeRegisters(std::map<std::string, std::string> &regs,
-                       bool hexIndex) const;
   std::string encodeRegisters() const;
+  std::string encodeMemory() const;
+  std::string encodeThreadsStopInfo() const;
 
 public:
   inline void clear() {
@@ -74,6 +81,9 @@ public:
     threadName.clear();
     registers.clear();
     threads.clear();
+    threadPCs.clear();
+    threadStops.clear();
+    memory.clear();
     ds2::StopInfo::clear();
     watchpointAddress = 0;
     watchpointIndex = -1;
@@ -106,6 +116,19 @@ struct ThreadResumeAction {
   ThreadResumeAction() : action(kResumeActionInvalid), signal(0), ncycles(0) {}
 };
 
+// Largest packet we accept, advertised as PacketSize in qSupported; replies
+// that carry lists are split so as not to exceed it either.
+static size_t const kMaxPacketSize = 0x3fff;
+
+// What the response to a static query depends on; see
+// Session::sendCachedResponse.
+enum ResponseScope {
+  kResponseScopeHost,      // The machine the server runs on
+  kResponseScopeRegisters, // The register layout of the inferior
+  kResponseScopeProcess,   // The inferior and its current image
+  kResponseScopeCount
+};
+
 struct Feature {
   typedef std::vector<Feature> Collection;
 
@@ -29,6 +29,10 @@ public:
 public:
   virtual bool wait(int ms = -1) = 0;
 
+  // Makes wait return in the thread blocked on it; can be called from any
+  // thread. Channels that can't be woken up ignore it.
+  virtual void wake() {}
+
 public:
   virtual ssize_t send(void const *buffer, size_t length) = 0;
   virtual ssize_t receive(void *buffer, size_t length) = 0;
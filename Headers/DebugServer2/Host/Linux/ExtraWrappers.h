@@ -22,6 +22,7 @@
 #endif
 #include <sys/ptrace.h>
 #include <sys/syscall.h>
+#include <sys/uio.h>
 #include <sys/user.h>
 #include <unistd.h>
 
@@ -39,6 +40,14 @@ struct xstate_hdr {
   uint64_t reserved2[5];
 } DS2_ATTRIBUTE_PACKED;
 
+// The kernel stores the state components it enabled (XCR0) in the
+// software-reserved bytes of the FXSAVE area.
+static size_t const kXSaveXCR0Offset = 464;
+
+// XSAVE state components for the x87, SSE and AVX registers.
+static uint64_t const kXFeatureMaskFPSSE = 0x3;
+static uint64_t const kXFeatureMaskAVX = 0x7;
+
 #if defined(ARCH_ARM)
 #if !defined(ARM_VFPREGS_SIZE)
 #define ARM_VFPREGS_SIZE (32 * 8 + 4)
@@ -63,6 +72,35 @@ struct xfpregs_struct {
 static inline int posix_openpt(int flags) { return ::open("/dev/ptmx", flags); }
 #endif // !HAVE_POSIX_OPENPT
 
+#if !defined(HAVE_PROCESS_VM_READV)
+// Older android sysroots don't have wrappers for the cross-memory-attach
+// syscalls, even though the kernel supports them.
+#if !defined(SYS_process_vm_readv)
+#define SYS_process_vm_readv __NR_process_vm_readv
+#endif // !SYS_process_vm_readv
+#if !defined(SYS_process_vm_writev)
+#define SYS_process_vm_writev __NR_process_vm_writev
+#endif // !SYS_process_vm_writev
+
+static inline ssize_t process_vm_readv(pid_t pid, struct iovec const *lvec,
+                                       unsigned long liovcnt,
+                                       struct iovec const *rvec,
+                                       unsigned long riovcnt,
+                                       unsigned long flags) {
+  return ::syscall(SYS_process_vm_readv, pid, lvec, liovcnt, rvec, riovcnt,
+                   flags);
+}
+
+static inline ssize_t process_vm_writev(pid_t pid, struct iovec const *lvec,
+                                        unsigned long liovcnt,
+                                        struct iovec const *rvec,
+                                        unsigned long riovcnt,
+                                        unsigned long flags) {
+  return ::syscall(SYS_process_vm_writev, pid, lvec, liovcnt, rvec, riovcnt,
+                   flags);
+}
+#endif // !HAVE_PROCESS_VM_READV
+
 #if !defined(PLATFORM_ANDROID)
 // Android headers do have a wrapper for `gettid`, unlike glibc.
 static inline pid_t gettid() { return ::syscall(SYS_gettid); }
@@ -114,6 +152,22 @@ static inline int personality(unsigned long persona) {
 #define PTRACE_SETREGSET 0x4205
 #endif // !PTRACE_SETREGSET
 
+#if !defined(PTRACE_SEIZE)
+#define PTRACE_SEIZE 0x4206
+#endif // !PTRACE_SEIZE
+
+#if !defined(PTRACE_INTERRUPT)
+#define PTRACE_INTERRUPT 0x4207
+#endif // !PTRACE_INTERRUPT
+
+#if !defined(PTRACE_LISTEN)
+#define PTRACE_LISTEN 0x4208
+#endif // !PTRACE_LISTEN
+
+#if !defined(PTRACE_EVENT_STOP)
+#define PTRACE_EVENT_STOP 128
+#endif // !PTRACE_EVENT_STOP
+
 // As defined in <asm-generic/siginfo.h>, missing in glibc
 #if !defined(TRAP_BRKPT)
 #define TRAP_BRKPT 1
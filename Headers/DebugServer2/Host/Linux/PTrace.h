@@ -22,17 +22,41 @@ namespace Linux {
 struct PTracePrivateData;
 
 class PTrace : public POSIX::PTrace {
+protected:
+  ProcessId _memoryPid;
+  int _memoryFd;
+
+public:
+  PTrace();
+  ~PTrace() override;
+
 public:
   ErrorCode wait(ProcessThreadId const &ptid, int *status = nullptr) override;
 
 public:
   ErrorCode traceMe(bool disableASLR) override;
   ErrorCode traceThat(ProcessId pid) override;
+  ErrorCode traceChild(ProcessId pid);
+
+public:
+  ErrorCode attach(ProcessId pid) override;
+  ErrorCode suspend(ProcessThreadId const &ptid) override;
+  ErrorCode listen(ProcessThreadId const &ptid);
 
 public:
   ErrorCode kill(ProcessThreadId const &ptid, int signal) override;
 
+public:
+  ErrorCode openMemoryFile(ProcessId pid);
+  void closeMemoryFile();
+
 protected:
+  ssize_t transferMemoryFile(uintptr_t address, void *buffer, size_t length,
+                             bool write);
+  ErrorCode peekBytes(pid_t pid, uintptr_t address, void *buffer,
+                      size_t length, size_t &nread);
+  ErrorCode pokeBytes(pid_t pid, uintptr_t address, void const *buffer,
+                      size_t length, size_t &nwritten);
   virtual ErrorCode readBytes(ProcessThreadId const &ptid,
                               Address const &address, void *buffer,
                               size_t length, size_t *count, bool nullTerm);
@@ -80,6 +104,12 @@ protected:
   uintptr_t readUserData(ProcessThreadId const &ptid, uint64_t offset);
   ErrorCode writeUserData(ProcessThreadId const &ptid, uint64_t offset,
                           uintptr_t val);
+
+protected:
+  // XSAVE area transferred with NT_X86_XSTATE. The kernel only accepts
+  // writes of the whole area, so CPUState keeps the area it was read from.
+  ErrorCode readXState(pid_t pid, ByteVector &xstate);
+  ErrorCode writeXState(pid_t pid, ByteVector const &xstate);
 #endif
 
 // Debug register ptrace APIs only exist for Linux ARM
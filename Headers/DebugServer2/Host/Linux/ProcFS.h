@@ -27,6 +27,10 @@ namespace Linux {
 // On Linux, COMM field is 16 chars long
 static size_t const kCOMMLengthMax = 16;
 
+// Bit of a /proc/XYZ/pagemap entry set when the page was written since the
+// soft-dirty bits were last cleared.
+static uint64_t const kPageMapSoftDirty = 1ULL << 55;
+
 enum ProcState {
   kProcStateUninterruptible = 'D',
   kProcStateRunning = 'R',
@@ -124,6 +128,10 @@ public:
   static bool ReadStat(pid_t pid, pid_t tid, Stat &stat);
   static bool ReadProcessIds(pid_t pid, pid_t &ppid, uid_t &uid, uid_t &euid,
                              gid_t &gid, gid_t &egid);
+  static bool ReadMemoryMap(pid_t pid, MemoryRegionInfo::Collection &regions);
+  static bool ReadPageMap(pid_t pid, uint64_t page, size_t count,
+                          std::vector<uint64_t> &entries);
+  static bool ClearSoftDirtyBits(pid_t pid);
 
 public:
   struct ELFInfo {
@@ -56,6 +56,8 @@ public:
                                 size_t length, size_t *nwritten = nullptr) = 0;
 
 public:
+  // Only the register sets in state.validSets are transferred; targets
+  // that can't transfer them separately transfer the whole state.
   virtual ErrorCode readCPUState(ProcessThreadId const &ptid,
                                  ProcessInfo const &info,
                                  Architecture::CPUState &state) = 0;
@@ -45,6 +45,7 @@ public:
 
 public:
   bool wait(int ms = -1) override;
+  void wake() override;
 
 public:
   ssize_t send(void const *buffer, size_t length) override;
@@ -82,6 +82,9 @@ public:
 public:
   bool setNonBlocking();
 
+protected:
+  bool waitWritable();
+
 public:
   ssize_t send(void const *buffer, size_t length) override;
   ssize_t receive(void *buffer, size_t length) override;
@@ -21,17 +21,37 @@ namespace Linux {
 class Process : public POSIX::ELFProcess {
 protected:
   Host::Linux::PTrace _ptrace;
+  // Parsed /proc/<pid>/maps sorted by address, rebuilt on demand after the
+  // process ran.
+  MemoryRegionInfo::Collection _memoryMap;
 
 protected:
+  ErrorCode initialize(ProcessId pid, uint32_t flags) override;
   ErrorCode attach(int waitStatus) override;
 
 public:
+  ErrorCode detach() override;
+  ErrorCode suspend() override;
   ErrorCode terminate() override;
   bool isAlive() const override;
 
 public:
   ErrorCode getMemoryRegionInfo(Address const &address,
                                 MemoryRegionInfo &info) override;
+  ErrorCode enumerateMappedFiles(
+      std::function<void(MappedFileInfo const &)> const &cb) override;
+
+protected:
+  ErrorCode updateMemoryMap();
+  inline void flushMemoryMap() { _memoryMap.clear(); }
+
+public:
+  ErrorCode setDirtyPageTracking(bool enable) override;
+  ErrorCode getDirtyPages(Address const &address, size_t length,
+                          std::vector<bool> &dirty) override;
+
+protected:
+  ErrorCode clearDirtyPages() override;
 
 protected:
   ErrorCode executeCode(ByteVector const &codestr, uint64_t &result);
@@ -44,6 +64,9 @@ public:
 protected:
   ErrorCode checkMemoryErrorCode(uint64_t address);
 
+public:
+  ErrorCode setNonStop(bool enable) override;
+
 public:
   ErrorCode wait() override;
 
@@ -24,6 +24,14 @@ protected:
   friend class Process;
   Thread(Process *process, ThreadId tid);
 
+  // Whether the last stop we got for this thread was a group-stop, i.e. the
+  // inferior itself is stopped by job control until it gets a SIGCONT.
+  bool _groupStop;
+
+public:
+  ErrorCode step(int signal = 0, Address const &address = Address()) override;
+  ErrorCode resume(int signal = 0, Address const &address = Address()) override;
+
 #if defined(ARCH_X86) || defined(ARCH_X86_64)
 public:
   uintptr_t readDebugReg(size_t idx) const override;
@@ -33,6 +41,9 @@ public:
 protected:
   void fillWatchpointData();
 
+public:
+  void reconcileState() override;
+
 protected:
   ErrorCode updateStopInfo(int waitStatus) override;
   void updateState() override;
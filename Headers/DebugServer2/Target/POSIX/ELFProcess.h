@@ -37,6 +37,9 @@ public:
       std::function<
           void(Support::ELFSupport::AuxiliaryVectorEntry const &)> const &cb);
 
+protected:
+  void resetImage() override;
+
 protected:
   ErrorCode updateInfo() override;
   virtual ErrorCode updateAuxiliaryVector();
@@ -18,12 +18,41 @@ namespace Target {
 namespace POSIX {
 
 class Thread : public ds2::Target::ThreadBase {
+protected:
+  // Register values are fetched once per stop, one register set at a time
+  // (_cpuState.validSets), and written back only when the thread is resumed.
+  Architecture::CPUState _cpuState;
+  uint32_t _cpuStateDirtySets;
+  uint64_t _cpuStateCacheHits;
+  uint64_t _cpuStateCacheMisses;
+  uint64_t _cpuStateWritesSaved;
+
 protected:
   Thread(ds2::Target::Process *process, ThreadId tid);
 
 public:
   ErrorCode readCPUState(Architecture::CPUState &state) override;
   ErrorCode writeCPUState(Architecture::CPUState const &state) override;
+  ErrorCode writeCPURegisterSets(Architecture::CPUState const &state,
+                                 uint32_t sets) override;
+
+protected:
+  ErrorCode fetchCPURegisterSets(Architecture::CPUState &state,
+                                 uint32_t sets) override;
+
+public:
+  ErrorCode flushCPUState();
+  inline void invalidateCPUState() {
+    _cpuState.validSets = 0;
+    _cpuStateDirtySets = 0;
+  }
+
+public:
+  // Number of register reads served from the cache, of reads that had to
+  // go to the kernel, and of register writes merged into a later one.
+  inline uint64_t cpuStateCacheHits() const { return _cpuStateCacheHits; }
+  inline uint64_t cpuStateCacheMisses() const { return _cpuStateCacheMisses; }
+  inline uint64_t cpuStateWritesSaved() const { return _cpuStateWritesSaved; }
 
 public:
   ErrorCode terminate() override;
@@ -35,11 +35,22 @@ protected:
   ProcessInfo _info;
   Address _loadBase;
   Address _entryPoint;
+  uint32_t _imageGeneration;
+  uint32_t _stopGeneration;
+  bool _nonStop;
   IdentityMap _threads;
   Thread *_currentThread;
   mutable std::unique_ptr<SoftwareBreakpointManager> _softwareBreakpointManager;
   mutable std::unique_ptr<HardwareBreakpointManager> _hardwareBreakpointManager;
 
+protected:
+  // Page-sized copies of the inferior memory, only valid until the next
+  // resume; indexed by page address.
+  std::map<uint64_t, ByteVector> _memoryCache;
+  uint64_t _memoryCacheHits;
+  uint64_t _memoryCacheMisses;
+  bool _dirtyPageTracking;
+
 protected:
   ProcessBase();
   virtual ~ProcessBase();
@@ -54,6 +65,14 @@ public:
   inline Address const &loadBase() const { return _loadBase; }
   inline Address const &entryPoint() const { return _entryPoint; }
 
+public:
+  // Changes whenever the process replaces its image (exec), and is never
+  // reused by another process debugged by this server.
+  inline uint32_t imageGeneration() const { return _imageGeneration; }
+  // Changes every time the process resumes, so that what was gathered
+  // while it was stopped can tell it is stale.
+  inline uint32_t stopGeneration() const { return _stopGeneration; }
+
 public:
   inline Thread *currentThread() const {
     return const_cast<ProcessBase *>(this)->_currentThread;
@@ -73,6 +92,10 @@ public: // ELF only
 protected:
   virtual void cleanup();
 
+protected:
+  // Forgets what was derived from the previous image after an exec.
+  virtual void resetImage();
+
 public:
   virtual ErrorCode detach() = 0;
 
@@ -113,6 +136,43 @@ public:
   ErrorCode writeMemoryBuffer(Address const &address, ByteVector const &buffer,
                               size_t length, size_t *nwritten = nullptr);
 
+protected:
+  typedef std::function<ErrorCode(Address const &, void *, size_t, size_t *)>
+      MemoryReader;
+
+  ErrorCode readMemoryCached(Address const &address, void *buffer,
+                             size_t length, size_t *nread,
+                             MemoryReader const &reader);
+  void updateMemoryCache(Address const &address, void const *buffer,
+                         size_t length);
+  void flushMemoryCache();
+
+public:
+  inline uint64_t memoryCacheHits() const { return _memoryCacheHits; }
+  inline uint64_t memoryCacheMisses() const { return _memoryCacheMisses; }
+
+public:
+  // When enabled, the pages written by the inferior are tracked between
+  // the last resume and the current stop.
+  virtual ErrorCode setDirtyPageTracking(bool enable) {
+    return enable ? kErrorUnsupported : kSuccess;
+  }
+  virtual ErrorCode getDirtyPages(Address const &address, size_t length,
+                                  std::vector<bool> &dirty) {
+    return kErrorUnsupported;
+  }
+
+protected:
+  virtual ErrorCode clearDirtyPages() { return kErrorUnsupported; }
+
+public:
+  // In non-stop mode, threads are resumed and stopped on their own and wait
+  // doesn't block; it returns kErrorNotFound when no thread has stopped.
+  inline bool nonStop() const { return _nonStop; }
+  virtual ErrorCode setNonStop(bool enable) {
+    return enable ? kErrorUnsupported : kSuccess;
+  }
+
 public:
   virtual ErrorCode wait() = 0;
 
@@ -140,6 +200,12 @@ public:
   virtual ErrorCode beforeResume();
   virtual ErrorCode afterResume();
 
+public:
+  // The non-stop mode counterparts of beforeResume and afterResume, called
+  // around each thread that runs while the others may still be running.
+  virtual ErrorCode beforeThreadResume(Thread *thread);
+  virtual ErrorCode afterThreadStop(Thread *thread);
+
 public:
   virtual int getMaxBreakpoints() const { return 0; }
   virtual int getMaxWatchpoints() const { return 0; }
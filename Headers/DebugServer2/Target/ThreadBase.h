@@ -16,6 +16,7 @@
 #include "DebugServer2/Utils/Log.h"
 
 #include <functional>
+#include <string>
 
 namespace ds2 {
 namespace Target {
@@ -29,6 +30,10 @@ protected:
   ThreadId _tid;
   StopInfo _stopInfo;
   State _state;
+  std::string _name;
+  uint32_t _nameGeneration;
+  uint32_t _nameStopGeneration;
+  uint32_t _creationStopGeneration;
 
 protected:
   ThreadBase(Process *process, ThreadId tid);
@@ -62,6 +67,23 @@ public:
   virtual ErrorCode modifyRegisters(
       std::function<void(Architecture::CPUState &state)> action) final;
 
+  // Same as readCPUState, but also fetches the register sets in |sets| if
+  // readCPUState left them out (see CPUState::validSets).
+  ErrorCode readCPURegisterSets(Architecture::CPUState &state, uint32_t sets);
+
+  // Same as writeCPUState, when only the register sets in |sets| were
+  // modified; targets that cache registers only write those back.
+  virtual ErrorCode writeCPURegisterSets(Architecture::CPUState const &state,
+                                         uint32_t sets) {
+    return writeCPUState(state);
+  }
+
+protected:
+  virtual ErrorCode fetchCPURegisterSets(Architecture::CPUState &state,
+                                         uint32_t sets) {
+    return kErrorUnsupported;
+  }
+
 #if defined(ARCH_X86) || defined(ARCH_X86_64)
 public:
   virtual uintptr_t readDebugReg(size_t idx) const {
@@ -76,6 +98,20 @@ public:
 public:
   inline uint32_t core() const { return _stopInfo.core; }
 
+public:
+  // Thread names hardly ever change once threads have started; the name is
+  // read from the system when first asked for and at the next stop if the
+  // thread was still new, then again only after the process image changed
+  // or invalidateName was called.
+  std::string const &name();
+  inline void invalidateName() { _nameGeneration = 0; }
+
+public:
+  // Ask the system for the state of the thread and the core it last ran on;
+  // targets that track thread states from debug events alone only do this
+  // when explicitly asked to.
+  virtual void reconcileState() { updateState(); }
+
 protected:
   friend class ProcessBase;
   virtual void updateState() = 0;
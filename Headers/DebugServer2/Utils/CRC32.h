@@ -0,0 +1,27 @@
+//
+// Copyright (c) 2014-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the University of Illinois/NCSA Open
+// Source License found in the LICENSE file in the root directory of this
+// source tree. An additional grant of patent rights can be found in the
+// PATENTS file in the same directory.
+//
+
+#ifndef __DebugServer2_Utils_CRC32_h
+#define __DebugServer2_Utils_CRC32_h
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ds2 {
+namespace Utils {
+
+// CRC-32 as computed by GDB for qCRC: polynomial 0x04c11db7, processed most
+// significant bit first, without final inversion. Start with 0xffffffff and
+// feed the result of the previous call to process data in several pieces.
+uint32_t CRC32(void const *data, size_t length, uint32_t crc = 0xffffffff);
+}
+}
+
+#endif // !__DebugServer2_Utils_CRC32_h
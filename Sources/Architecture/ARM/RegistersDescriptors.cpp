@@ -11,6 +11,7 @@ using ds2::Architecture::GDBVectorUnion;
 using ds2::Architecture::GDBVectorUnionField;
 using ds2::Architecture::GDBFeature;
 using ds2::Architecture::GDBFeatureEntry;
+using ds2::Architecture::LLDBRegisterInfo;
 using ds2::Architecture::LLDBRegisterSet;
 
 #if defined(ENDIAN_BIG)
@@ -176,6 +177,240 @@ LLDBRegisterSet const lldb_reg_set_1 = {"VFP Registers", 81, lldb_reg_defs_1};
 LLDBRegisterSet const *const lldb_reg_sets[] = {&lldb_reg_set_0,
                                                 &lldb_reg_set_1, nullptr};
 
+//
+// LLDB Register Lookup Tables
+//
+
+constexpr LLDBRegisterInfo lldb_reg_index[] = {
+    {"General Purpose Registers", &reg_def_r0},
+    {"General Purpose Registers", &reg_def_r1},
+    {"General Purpose Registers", &reg_def_r2},
+    {"General Purpose Registers", &reg_def_r3},
+    {"General Purpose Registers", &reg_def_r4},
+    {"General Purpose Registers", &reg_def_r5},
+    {"General Purpose Registers", &reg_def_r6},
+    {"General Purpose Registers", &reg_def_r7},
+    {"General Purpose Registers", &reg_def_r8},
+    {"General Purpose Registers", &reg_def_r9},
+    {"General Purpose Registers", &reg_def_r10},
+    {"General Purpose Registers", &reg_def_r11},
+    {"General Purpose Registers", &reg_def_r12},
+    {"General Purpose Registers", &reg_def_r13},
+    {"General Purpose Registers", &reg_def_r14},
+    {"General Purpose Registers", &reg_def_r15},
+    {"General Purpose Registers", &reg_def_cpsr},
+    {"VFP Registers", &reg_def_s0},
+    {"VFP Registers", &reg_def_s1},
+    {"VFP Registers", &reg_def_s2},
+    {"VFP Registers", &reg_def_s3},
+    {"VFP Registers", &reg_def_s4},
+    {"VFP Registers", &reg_def_s5},
+    {"VFP Registers", &reg_def_s6},
+    {"VFP Registers", &reg_def_s7},
+    {"VFP Registers", &reg_def_s8},
+    {"VFP Registers", &reg_def_s9},
+    {"VFP Registers", &reg_def_s10},
+    {"VFP Registers", &reg_def_s11},
+    {"VFP Registers", &reg_def_s12},
+    {"VFP Registers", &reg_def_s13},
+    {"VFP Registers", &reg_def_s14},
+    {"VFP Registers", &reg_def_s15},
+    {"VFP Registers", &reg_def_s16},
+    {"VFP Registers", &reg_def_s17},
+    {"VFP Registers", &reg_def_s18},
+    {"VFP Registers", &reg_def_s19},
+    {"VFP Registers", &reg_def_s20},
+    {"VFP Registers", &reg_def_s21},
+    {"VFP Registers", &reg_def_s22},
+    {"VFP Registers", &reg_def_s23},
+    {"VFP Registers", &reg_def_s24},
+    {"VFP Registers", &reg_def_s25},
+    {"VFP Registers", &reg_def_s26},
+    {"VFP Registers", &reg_def_s27},
+    {"VFP Registers", &reg_def_s28},
+    {"VFP Registers", &reg_def_s29},
+    {"VFP Registers", &reg_def_s30},
+    {"VFP Registers", &reg_def_s31},
+    {"VFP Registers", &reg_def_d0},
+    {"VFP Registers", &reg_def_d1},
+    {"VFP Registers", &reg_def_d2},
+    {"VFP Registers", &reg_def_d3},
+    {"VFP Registers", &reg_def_d4},
+    {"VFP Registers", &reg_def_d5},
+    {"VFP Registers", &reg_def_d6},
+    {"VFP Registers", &reg_def_d7},
+    {"VFP Registers", &reg_def_d8},
+    {"VFP Registers", &reg_def_d9},
+    {"VFP Registers", &reg_def_d10},
+    {"VFP Registers", &reg_def_d11},
+    {"VFP Registers", &reg_def_d12},
+    {"VFP Registers", &reg_def_d13},
+    {"VFP Registers", &reg_def_d14},
+    {"VFP Registers", &reg_def_d15},
+    {"VFP Registers", &reg_def_d16},
+    {"VFP Registers", &reg_def_d17},
+    {"VFP Registers", &reg_def_d18},
+    {"VFP Registers", &reg_def_d19},
+    {"VFP Registers", &reg_def_d20},
+    {"VFP Registers", &reg_def_d21},
+    {"VFP Registers", &reg_def_d22},
+    {"VFP Registers", &reg_def_d23},
+    {"VFP Registers", &reg_def_d24},
+    {"VFP Registers", &reg_def_d25},
+    {"VFP Registers", &reg_def_d26},
+    {"VFP Registers", &reg_def_d27},
+    {"VFP Registers", &reg_def_d28},
+    {"VFP Registers", &reg_def_d29},
+    {"VFP Registers", &reg_def_d30},
+    {"VFP Registers", &reg_def_d31},
+    {"VFP Registers", &reg_def_q0},
+    {"VFP Registers", &reg_def_q1},
+    {"VFP Registers", &reg_def_q2},
+    {"VFP Registers", &reg_def_q3},
+    {"VFP Registers", &reg_def_q4},
+    {"VFP Registers", &reg_def_q5},
+    {"VFP Registers", &reg_def_q6},
+    {"VFP Registers", &reg_def_q7},
+    {"VFP Registers", &reg_def_q8},
+    {"VFP Registers", &reg_def_q9},
+    {"VFP Registers", &reg_def_q10},
+    {"VFP Registers", &reg_def_q11},
+    {"VFP Registers", &reg_def_q12},
+    {"VFP Registers", &reg_def_q13},
+    {"VFP Registers", &reg_def_q14},
+    {"VFP Registers", &reg_def_q15},
+    {"VFP Registers", &reg_def_fpscr},
+};
+
+constexpr uint32_t lldb_reg_name_seeds[] = {
+    63,
+    1,
+    1,
+    35,
+    114,
+    986,
+    12,
+    1,
+    63,
+    7,
+    63,
+    20,
+    1,
+    1,
+    125,
+    113,
+    119,
+    113,
+    255,
+    129,
+    31,
+    627,
+    331,
+    0,
+    59,
+};
+
+constexpr int32_t lldb_reg_name_slots[] = {
+    0,
+    76,
+    57,
+    52,
+    39,
+    85,
+    6,
+    12,
+    90,
+    54,
+    95,
+    35,
+    94,
+    32,
+    44,
+    80,
+    26,
+    83,
+    40,
+    58,
+    60,
+    23,
+    24,
+    1,
+    21,
+    7,
+    33,
+    89,
+    2,
+    61,
+    55,
+    9,
+    91,
+    43,
+    18,
+    25,
+    88,
+    87,
+    64,
+    74,
+    16,
+    92,
+    66,
+    20,
+    4,
+    14,
+    93,
+    59,
+    11,
+    71,
+    68,
+    34,
+    38,
+    36,
+    53,
+    81,
+    49,
+    79,
+    47,
+    5,
+    62,
+    63,
+    97,
+    70,
+    46,
+    65,
+    67,
+    10,
+    8,
+    30,
+    17,
+    78,
+    84,
+    41,
+    42,
+    37,
+    69,
+    72,
+    77,
+    56,
+    75,
+    48,
+    73,
+    3,
+    86,
+    27,
+    51,
+    15,
+    29,
+    28,
+    82,
+    45,
+    31,
+    96,
+    13,
+    50,
+    22,
+    19,
+};
+
 //
 // GDB Features
 //
@@ -2414,7 +2649,8 @@ namespace ds2 {
 namespace Architecture {
 namespace ARM {
 
-LLDBDescriptor const LLDB = {2, lldb_reg_sets};
+LLDBDescriptor const LLDB = {2, lldb_reg_sets, 98, lldb_reg_index, 25,
+                             lldb_reg_name_seeds, 98, lldb_reg_name_slots};
 GDBDescriptor const GDB = {"arm", "GNU/Linux", 3, gdb_features};
 }
 }
@@ -107,7 +107,7 @@ int SoftwareBreakpointManager::hit(Target::Thread *thread, Site &site) {
     //
     // Move the PC back to the instruction
     //
-    if (thread->writeCPUState(state) != kSuccess) {
+    if (thread->writeCPURegisterSets(state, kRegisterSetGP) != kSuccess) {
       abort();
     }
     return 0;
@@ -231,6 +231,27 @@ ErrorCode SoftwareBreakpointManager::disableLocation(Site const &site) {
   return kSuccess;
 }
 
+void SoftwareBreakpointManager::restoreInstructions(Address const &address,
+                                                    void *buffer,
+                                                    size_t length) const {
+  uint8_t *bytes = static_cast<uint8_t *>(buffer);
+  uint64_t start = address.value();
+
+  //
+  // Breakpoint opcodes are up to 4 bytes long, the first one to look at may
+  // start a few bytes before the buffer.
+  //
+  for (auto it = _insns.lower_bound(start < 3 ? 0 : start - 3);
+       it != _insns.end() && it->first < start + length; ++it) {
+    for (size_t n = 0; n < it->second.size(); n++) {
+      uint64_t addr = it->first + n;
+      if (addr >= start && addr < start + length) {
+        bytes[addr - start] = it->second[n];
+      }
+    }
+  }
+}
+
 ErrorCode SoftwareBreakpointManager::isValid(Address const &address,
                                              size_t size, Mode mode) const {
   DS2ASSERT(mode == kModeExec);
@@ -11,6 +11,7 @@ using ds2::Architecture::GDBVectorUnion;
 using ds2::Architecture::GDBVectorUnionField;
 using ds2::Architecture::GDBFeature;
 using ds2::Architecture::GDBFeatureEntry;
+using ds2::Architecture::LLDBRegisterInfo;
 using ds2::Architecture::LLDBRegisterSet;
 
 #if defined(ENDIAN_BIG)
@@ -123,6 +124,166 @@ LLDBRegisterSet const lldb_reg_set_0 = {"General Purpose Registers", 65,
 
 LLDBRegisterSet const *const lldb_reg_sets[] = {&lldb_reg_set_0, nullptr};
 
+//
+// LLDB Register Lookup Tables
+//
+
+constexpr LLDBRegisterInfo lldb_reg_index[] = {
+    {"General Purpose Registers", &reg_def_r0},
+    {"General Purpose Registers", &reg_def_r1},
+    {"General Purpose Registers", &reg_def_r2},
+    {"General Purpose Registers", &reg_def_r3},
+    {"General Purpose Registers", &reg_def_r4},
+    {"General Purpose Registers", &reg_def_r5},
+    {"General Purpose Registers", &reg_def_r6},
+    {"General Purpose Registers", &reg_def_r7},
+    {"General Purpose Registers", &reg_def_r8},
+    {"General Purpose Registers", &reg_def_r9},
+    {"General Purpose Registers", &reg_def_r10},
+    {"General Purpose Registers", &reg_def_r11},
+    {"General Purpose Registers", &reg_def_r12},
+    {"General Purpose Registers", &reg_def_r13},
+    {"General Purpose Registers", &reg_def_r14},
+    {"General Purpose Registers", &reg_def_r15},
+    {"General Purpose Registers", &reg_def_r16},
+    {"General Purpose Registers", &reg_def_r17},
+    {"General Purpose Registers", &reg_def_r18},
+    {"General Purpose Registers", &reg_def_r19},
+    {"General Purpose Registers", &reg_def_r20},
+    {"General Purpose Registers", &reg_def_r21},
+    {"General Purpose Registers", &reg_def_r22},
+    {"General Purpose Registers", &reg_def_r23},
+    {"General Purpose Registers", &reg_def_r24},
+    {"General Purpose Registers", &reg_def_r25},
+    {"General Purpose Registers", &reg_def_r26},
+    {"General Purpose Registers", &reg_def_r27},
+    {"General Purpose Registers", &reg_def_r28},
+    {"General Purpose Registers", &reg_def_r29},
+    {"General Purpose Registers", &reg_def_r30},
+    {"General Purpose Registers", &reg_def_r31},
+    {"General Purpose Registers", &reg_def_pc},
+    {"General Purpose Registers", &reg_def_cpsr},
+    {"General Purpose Registers", &reg_def_w0},
+    {"General Purpose Registers", &reg_def_w1},
+    {"General Purpose Registers", &reg_def_w2},
+    {"General Purpose Registers", &reg_def_w3},
+    {"General Purpose Registers", &reg_def_w4},
+    {"General Purpose Registers", &reg_def_w5},
+    {"General Purpose Registers", &reg_def_w6},
+    {"General Purpose Registers", &reg_def_w7},
+    {"General Purpose Registers", &reg_def_w8},
+    {"General Purpose Registers", &reg_def_w9},
+    {"General Purpose Registers", &reg_def_w10},
+    {"General Purpose Registers", &reg_def_w11},
+    {"General Purpose Registers", &reg_def_w12},
+    {"General Purpose Registers", &reg_def_w13},
+    {"General Purpose Registers", &reg_def_w14},
+    {"General Purpose Registers", &reg_def_w15},
+    {"General Purpose Registers", &reg_def_w16},
+    {"General Purpose Registers", &reg_def_w17},
+    {"General Purpose Registers", &reg_def_w18},
+    {"General Purpose Registers", &reg_def_w19},
+    {"General Purpose Registers", &reg_def_w20},
+    {"General Purpose Registers", &reg_def_w21},
+    {"General Purpose Registers", &reg_def_w22},
+    {"General Purpose Registers", &reg_def_w23},
+    {"General Purpose Registers", &reg_def_w24},
+    {"General Purpose Registers", &reg_def_w25},
+    {"General Purpose Registers", &reg_def_w26},
+    {"General Purpose Registers", &reg_def_w27},
+    {"General Purpose Registers", &reg_def_w28},
+    {"General Purpose Registers", &reg_def_w29},
+    {"General Purpose Registers", &reg_def_w30},
+};
+
+constexpr uint32_t lldb_reg_name_seeds[] = {
+    4,
+    1,
+    1,
+    74,
+    232,
+    160,
+    5,
+    3,
+    1,
+    24,
+    1588,
+    73,
+    2,
+    5801,
+    38,
+    14,
+    1282,
+};
+
+constexpr int32_t lldb_reg_name_slots[] = {
+    10,
+    56,
+    28,
+    51,
+    2,
+    41,
+    44,
+    49,
+    18,
+    0,
+    19,
+    59,
+    38,
+    17,
+    37,
+    20,
+    4,
+    7,
+    42,
+    23,
+    13,
+    54,
+    8,
+    33,
+    22,
+    61,
+    3,
+    36,
+    11,
+    5,
+    48,
+    40,
+    34,
+    30,
+    63,
+    57,
+    60,
+    26,
+    12,
+    32,
+    1,
+    29,
+    9,
+    25,
+    47,
+    16,
+    14,
+    55,
+    15,
+    62,
+    35,
+    43,
+    21,
+    24,
+    39,
+    6,
+    53,
+    31,
+    27,
+    64,
+    45,
+    58,
+    46,
+    52,
+    50,
+};
+
 //
 // GDB Features
 //
@@ -1521,7 +1682,8 @@ namespace ds2 {
 namespace Architecture {
 namespace ARM64 {
 
-LLDBDescriptor const LLDB = {1, lldb_reg_sets};
+LLDBDescriptor const LLDB = {1, lldb_reg_sets, 65, lldb_reg_index, 17,
+                             lldb_reg_name_seeds, 65, lldb_reg_name_slots};
 GDBDescriptor const GDB = {"aarch64", "GNU/Linux", 1, gdb_features};
 }
 }
@@ -413,41 +413,33 @@ std::string LLDBGenerateXMLMain(LLDBDescriptor const &desc) {
 
 bool LLDBGetRegisterInfo(LLDBDescriptor const &desc, size_t index,
                          LLDBRegisterInfo &info) {
-  for (size_t nset = 0; nset < desc.Count; nset++) {
-    LLDBRegisterSet const *set = desc.Sets[nset];
-    if (index >= set->Count) {
-      index -= set->Count;
-      continue;
-    }
-
-    info.SetName = set->Name;
-    info.Def = set->Defs[index];
-    return true;
-  }
+  if (index >= desc.RegisterCount)
+    return false;
 
-  return false;
+  info = desc.Registers[index];
+  return true;
 }
 
 bool LLDBGetRegisterInfo(LLDBDescriptor const &desc, std::string const &name,
                          LLDBRegisterInfo &info) {
-  if (name.empty())
+  if (name.empty() || desc.NameSlotCount == 0)
     return false;
 
-  for (size_t nset = 0; nset < desc.Count; nset++) {
-    LLDBRegisterSet const *set = desc.Sets[nset];
-    RegisterDef const *const *defs = set->Defs;
-    for (size_t index = 0; defs[index] != nullptr; index++) {
-      RegisterDef const *rd = defs[index];
-      if ((rd->LLDBName != nullptr && rd->LLDBName == name) ||
-          rd->Name == name) {
-        info.SetName = set->Name;
-        info.Def = rd;
-        return true;
-      }
-    }
-  }
+  char const *str = name.c_str();
+  size_t length = name.length();
+
+  uint32_t seed = desc.NameSeeds[RegisterNameHash(str, length, 0) %
+                                 desc.NameSeedCount];
+  int32_t index = desc.NameSlots[RegisterNameHash(str, length, seed) %
+                                 desc.NameSlotCount];
+
+  // Names that aren't in the table still land on some slot.
+  RegisterDef const *rd = desc.Registers[index].Def;
+  if ((rd->LLDBName == nullptr || rd->LLDBName != name) && rd->Name != name)
+    return false;
 
-  return false;
+  info = desc.Registers[index];
+  return true;
 }
 }
 }
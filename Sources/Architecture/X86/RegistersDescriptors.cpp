@@ -11,6 +11,7 @@ using ds2::Architecture::GDBVectorUnion;
 using ds2::Architecture::GDBVectorUnionField;
 using ds2::Architecture::GDBFeature;
 using ds2::Architecture::GDBFeatureEntry;
+using ds2::Architecture::LLDBRegisterInfo;
 using ds2::Architecture::LLDBRegisterSet;
 
 #if defined(ENDIAN_BIG)
@@ -181,6 +182,178 @@ LLDBRegisterSet const lldb_reg_set_2 = {"Advanced Vector Extensions", 8,
 LLDBRegisterSet const *const lldb_reg_sets[] = {
     &lldb_reg_set_0, &lldb_reg_set_1, &lldb_reg_set_2, nullptr};
 
+//
+// LLDB Register Lookup Tables
+//
+
+constexpr LLDBRegisterInfo lldb_reg_index[] = {
+    {"General Purpose Registers", &reg_def_eax},
+    {"General Purpose Registers", &reg_def_ebx},
+    {"General Purpose Registers", &reg_def_ecx},
+    {"General Purpose Registers", &reg_def_edx},
+    {"General Purpose Registers", &reg_def_esi},
+    {"General Purpose Registers", &reg_def_edi},
+    {"General Purpose Registers", &reg_def_ebp},
+    {"General Purpose Registers", &reg_def_esp},
+    {"General Purpose Registers", &reg_def_eip},
+    {"General Purpose Registers", &reg_def_eflags},
+    {"General Purpose Registers", &reg_def_cs},
+    {"General Purpose Registers", &reg_def_ss},
+    {"General Purpose Registers", &reg_def_ds},
+    {"General Purpose Registers", &reg_def_es},
+    {"General Purpose Registers", &reg_def_fs},
+    {"General Purpose Registers", &reg_def_gs},
+    {"General Purpose Registers", &reg_def_ax},
+    {"General Purpose Registers", &reg_def_bx},
+    {"General Purpose Registers", &reg_def_cx},
+    {"General Purpose Registers", &reg_def_dx},
+    {"General Purpose Registers", &reg_def_si},
+    {"General Purpose Registers", &reg_def_di},
+    {"General Purpose Registers", &reg_def_bp},
+    {"General Purpose Registers", &reg_def_sp},
+    {"General Purpose Registers", &reg_def_ah},
+    {"General Purpose Registers", &reg_def_bh},
+    {"General Purpose Registers", &reg_def_ch},
+    {"General Purpose Registers", &reg_def_dh},
+    {"General Purpose Registers", &reg_def_al},
+    {"General Purpose Registers", &reg_def_bl},
+    {"General Purpose Registers", &reg_def_cl},
+    {"General Purpose Registers", &reg_def_dl},
+    {"Floating Point Registers", &reg_def_fctrl},
+    {"Floating Point Registers", &reg_def_fstat},
+    {"Floating Point Registers", &reg_def_ftag},
+    {"Floating Point Registers", &reg_def_fiseg},
+    {"Floating Point Registers", &reg_def_fioff},
+    {"Floating Point Registers", &reg_def_foseg},
+    {"Floating Point Registers", &reg_def_fooff},
+    {"Floating Point Registers", &reg_def_fop},
+    {"Floating Point Registers", &reg_def_mxcsr},
+    {"Floating Point Registers", &reg_def_mxcsrmask},
+    {"Floating Point Registers", &reg_def_st0},
+    {"Floating Point Registers", &reg_def_st1},
+    {"Floating Point Registers", &reg_def_st2},
+    {"Floating Point Registers", &reg_def_st3},
+    {"Floating Point Registers", &reg_def_st4},
+    {"Floating Point Registers", &reg_def_st5},
+    {"Floating Point Registers", &reg_def_st6},
+    {"Floating Point Registers", &reg_def_st7},
+    {"Floating Point Registers", &reg_def_xmm0},
+    {"Floating Point Registers", &reg_def_xmm1},
+    {"Floating Point Registers", &reg_def_xmm2},
+    {"Floating Point Registers", &reg_def_xmm3},
+    {"Floating Point Registers", &reg_def_xmm4},
+    {"Floating Point Registers", &reg_def_xmm5},
+    {"Floating Point Registers", &reg_def_xmm6},
+    {"Floating Point Registers", &reg_def_xmm7},
+    {"Advanced Vector Extensions", &reg_def_ymm0},
+    {"Advanced Vector Extensions", &reg_def_ymm1},
+    {"Advanced Vector Extensions", &reg_def_ymm2},
+    {"Advanced Vector Extensions", &reg_def_ymm3},
+    {"Advanced Vector Extensions", &reg_def_ymm4},
+    {"Advanced Vector Extensions", &reg_def_ymm5},
+    {"Advanced Vector Extensions", &reg_def_ymm6},
+    {"Advanced Vector Extensions", &reg_def_ymm7},
+};
+
+constexpr uint32_t lldb_reg_name_seeds[] = {
+    1,
+    55,
+    33,
+    16,
+    2,
+    10,
+    6,
+    216,
+    342,
+    6982,
+    1,
+    45,
+    27,
+    5,
+    96,
+    107,
+    238,
+    14,
+    34,
+};
+
+constexpr int32_t lldb_reg_name_slots[] = {
+    4,
+    37,
+    19,
+    49,
+    41,
+    39,
+    29,
+    36,
+    45,
+    56,
+    1,
+    28,
+    31,
+    46,
+    63,
+    21,
+    47,
+    48,
+    22,
+    50,
+    58,
+    27,
+    51,
+    16,
+    40,
+    44,
+    47,
+    10,
+    13,
+    62,
+    24,
+    33,
+    25,
+    60,
+    18,
+    53,
+    5,
+    17,
+    52,
+    61,
+    64,
+    11,
+    44,
+    49,
+    42,
+    9,
+    26,
+    65,
+    6,
+    42,
+    57,
+    59,
+    8,
+    35,
+    48,
+    12,
+    14,
+    30,
+    3,
+    54,
+    34,
+    46,
+    43,
+    45,
+    23,
+    20,
+    15,
+    43,
+    0,
+    2,
+    7,
+    55,
+    32,
+    38,
+};
+
 //
 // GDB Features
 //
@@ -1706,7 +1879,8 @@ namespace ds2 {
 namespace Architecture {
 namespace X86 {
 
-LLDBDescriptor const LLDB = {3, lldb_reg_sets};
+LLDBDescriptor const LLDB = {3, lldb_reg_sets, 66, lldb_reg_index, 19,
+                             lldb_reg_name_seeds, 74, lldb_reg_name_slots};
 GDBDescriptor const GDB = {"i386:i386", "GNU/Linux", 3, gdb_features};
 }
 }
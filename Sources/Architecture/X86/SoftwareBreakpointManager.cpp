@@ -51,7 +51,7 @@ int SoftwareBreakpointManager::hit(Target::Thread *thread, Site &site) {
     // Move the PC back to the instruction, INT3 will move
     // the instruction pointer to the next byte.
     //
-    if (thread->writeCPUState(state) != kSuccess)
+    if (thread->writeCPURegisterSets(state, kRegisterSetGP) != kSuccess)
       abort();
 
     uint64_t ex = state.pc();
@@ -109,6 +109,18 @@ ErrorCode SoftwareBreakpointManager::disableLocation(Site const &site) {
   return kSuccess;
 }
 
+void SoftwareBreakpointManager::restoreInstructions(Address const &address,
+                                                    void *buffer,
+                                                    size_t length) const {
+  uint8_t *bytes = static_cast<uint8_t *>(buffer);
+  uint64_t start = address.value();
+
+  for (auto it = _insns.lower_bound(start);
+       it != _insns.end() && it->first < start + length; ++it) {
+    bytes[it->first - start] = it->second;
+  }
+}
+
 ErrorCode SoftwareBreakpointManager::isValid(Address const &address,
                                              size_t size, Mode mode) const {
   DS2ASSERT(size == 0 || size == 1);
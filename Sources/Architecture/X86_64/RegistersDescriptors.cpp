@@ -11,6 +11,7 @@ using ds2::Architecture::GDBVectorUnion;
 using ds2::Architecture::GDBVectorUnionField;
 using ds2::Architecture::GDBFeature;
 using ds2::Architecture::GDBFeatureEntry;
+using ds2::Architecture::LLDBRegisterInfo;
 using ds2::Architecture::LLDBRegisterSet;
 
 #if defined(ENDIAN_BIG)
@@ -257,6 +258,313 @@ LLDBRegisterSet const lldb_reg_set_2 = {"Advanced Vector Extensions", 16,
 LLDBRegisterSet const *const lldb_reg_sets[] = {
     &lldb_reg_set_0, &lldb_reg_set_1, &lldb_reg_set_2, nullptr};
 
+//
+// LLDB Register Lookup Tables
+//
+
+constexpr LLDBRegisterInfo lldb_reg_index[] = {
+    {"General Purpose Registers", &reg_def_rax},
+    {"General Purpose Registers", &reg_def_rbx},
+    {"General Purpose Registers", &reg_def_rcx},
+    {"General Purpose Registers", &reg_def_rdx},
+    {"General Purpose Registers", &reg_def_rsi},
+    {"General Purpose Registers", &reg_def_rdi},
+    {"General Purpose Registers", &reg_def_rbp},
+    {"General Purpose Registers", &reg_def_rsp},
+    {"General Purpose Registers", &reg_def_r8},
+    {"General Purpose Registers", &reg_def_r9},
+    {"General Purpose Registers", &reg_def_r10},
+    {"General Purpose Registers", &reg_def_r11},
+    {"General Purpose Registers", &reg_def_r12},
+    {"General Purpose Registers", &reg_def_r13},
+    {"General Purpose Registers", &reg_def_r14},
+    {"General Purpose Registers", &reg_def_r15},
+    {"General Purpose Registers", &reg_def_rip},
+    {"General Purpose Registers", &reg_def_eflags},
+    {"General Purpose Registers", &reg_def_cs},
+    {"General Purpose Registers", &reg_def_ss},
+    {"General Purpose Registers", &reg_def_ds},
+    {"General Purpose Registers", &reg_def_es},
+    {"General Purpose Registers", &reg_def_fs},
+    {"General Purpose Registers", &reg_def_gs},
+    {"General Purpose Registers", &reg_def_eax},
+    {"General Purpose Registers", &reg_def_ebx},
+    {"General Purpose Registers", &reg_def_ecx},
+    {"General Purpose Registers", &reg_def_edx},
+    {"General Purpose Registers", &reg_def_esi},
+    {"General Purpose Registers", &reg_def_edi},
+    {"General Purpose Registers", &reg_def_ebp},
+    {"General Purpose Registers", &reg_def_esp},
+    {"General Purpose Registers", &reg_def_r8d},
+    {"General Purpose Registers", &reg_def_r9d},
+    {"General Purpose Registers", &reg_def_r10d},
+    {"General Purpose Registers", &reg_def_r11d},
+    {"General Purpose Registers", &reg_def_r12d},
+    {"General Purpose Registers", &reg_def_r13d},
+    {"General Purpose Registers", &reg_def_r14d},
+    {"General Purpose Registers", &reg_def_r15d},
+    {"General Purpose Registers", &reg_def_ax},
+    {"General Purpose Registers", &reg_def_bx},
+    {"General Purpose Registers", &reg_def_cx},
+    {"General Purpose Registers", &reg_def_dx},
+    {"General Purpose Registers", &reg_def_si},
+    {"General Purpose Registers", &reg_def_di},
+    {"General Purpose Registers", &reg_def_bp},
+    {"General Purpose Registers", &reg_def_sp},
+    {"General Purpose Registers", &reg_def_r8w},
+    {"General Purpose Registers", &reg_def_r9w},
+    {"General Purpose Registers", &reg_def_r10w},
+    {"General Purpose Registers", &reg_def_r11w},
+    {"General Purpose Registers", &reg_def_r12w},
+    {"General Purpose Registers", &reg_def_r13w},
+    {"General Purpose Registers", &reg_def_r14w},
+    {"General Purpose Registers", &reg_def_r15w},
+    {"General Purpose Registers", &reg_def_ah},
+    {"General Purpose Registers", &reg_def_bh},
+    {"General Purpose Registers", &reg_def_ch},
+    {"General Purpose Registers", &reg_def_dh},
+    {"General Purpose Registers", &reg_def_al},
+    {"General Purpose Registers", &reg_def_bl},
+    {"General Purpose Registers", &reg_def_cl},
+    {"General Purpose Registers", &reg_def_dl},
+    {"General Purpose Registers", &reg_def_sil},
+    {"General Purpose Registers", &reg_def_dil},
+    {"General Purpose Registers", &reg_def_bpl},
+    {"General Purpose Registers", &reg_def_spl},
+    {"General Purpose Registers", &reg_def_r8l},
+    {"General Purpose Registers", &reg_def_r9l},
+    {"General Purpose Registers", &reg_def_r10l},
+    {"General Purpose Registers", &reg_def_r11l},
+    {"General Purpose Registers", &reg_def_r12l},
+    {"General Purpose Registers", &reg_def_r13l},
+    {"General Purpose Registers", &reg_def_r14l},
+    {"General Purpose Registers", &reg_def_r15l},
+    {"Floating Point Registers", &reg_def_fctrl},
+    {"Floating Point Registers", &reg_def_fstat},
+    {"Floating Point Registers", &reg_def_ftag},
+    {"Floating Point Registers", &reg_def_fiseg},
+    {"Floating Point Registers", &reg_def_fioff},
+    {"Floating Point Registers", &reg_def_foseg},
+    {"Floating Point Registers", &reg_def_fooff},
+    {"Floating Point Registers", &reg_def_fop},
+    {"Floating Point Registers", &reg_def_mxcsr},
+    {"Floating Point Registers", &reg_def_mxcsrmask},
+    {"Floating Point Registers", &reg_def_st0},
+    {"Floating Point Registers", &reg_def_st1},
+    {"Floating Point Registers", &reg_def_st2},
+    {"Floating Point Registers", &reg_def_st3},
+    {"Floating Point Registers", &reg_def_st4},
+    {"Floating Point Registers", &reg_def_st5},
+    {"Floating Point Registers", &reg_def_st6},
+    {"Floating Point Registers", &reg_def_st7},
+    {"Floating Point Registers", &reg_def_xmm0},
+    {"Floating Point Registers", &reg_def_xmm1},
+    {"Floating Point Registers", &reg_def_xmm2},
+    {"Floating Point Registers", &reg_def_xmm3},
+    {"Floating Point Registers", &reg_def_xmm4},
+    {"Floating Point Registers", &reg_def_xmm5},
+    {"Floating Point Registers", &reg_def_xmm6},
+    {"Floating Point Registers", &reg_def_xmm7},
+    {"Floating Point Registers", &reg_def_xmm8},
+    {"Floating Point Registers", &reg_def_xmm9},
+    {"Floating Point Registers", &reg_def_xmm10},
+    {"Floating Point Registers", &reg_def_xmm11},
+    {"Floating Point Registers", &reg_def_xmm12},
+    {"Floating Point Registers", &reg_def_xmm13},
+    {"Floating Point Registers", &reg_def_xmm14},
+    {"Floating Point Registers", &reg_def_xmm15},
+    {"Advanced Vector Extensions", &reg_def_ymm0},
+    {"Advanced Vector Extensions", &reg_def_ymm1},
+    {"Advanced Vector Extensions", &reg_def_ymm2},
+    {"Advanced Vector Extensions", &reg_def_ymm3},
+    {"Advanced Vector Extensions", &reg_def_ymm4},
+    {"Advanced Vector Extensions", &reg_def_ymm5},
+    {"Advanced Vector Extensions", &reg_def_ymm6},
+    {"Advanced Vector Extensions", &reg_def_ymm7},
+    {"Advanced Vector Extensions", &reg_def_ymm8},
+    {"Advanced Vector Extensions", &reg_def_ymm9},
+    {"Advanced Vector Extensions", &reg_def_ymm10},
+    {"Advanced Vector Extensions", &reg_def_ymm11},
+    {"Advanced Vector Extensions", &reg_def_ymm12},
+    {"Advanced Vector Extensions", &reg_def_ymm13},
+    {"Advanced Vector Extensions", &reg_def_ymm14},
+    {"Advanced Vector Extensions", &reg_def_ymm15},
+};
+
+constexpr uint32_t lldb_reg_name_seeds[] = {
+    56,
+    104,
+    255,
+    34,
+    6,
+    1,
+    119,
+    29,
+    12,
+    11,
+    958,
+    227,
+    3,
+    13,
+    10,
+    318,
+    535,
+    63,
+    1,
+    879,
+    4,
+    2,
+    16,
+    3,
+    89,
+    40,
+    1189,
+    28,
+    449,
+    34,
+    23,
+    34,
+    22626,
+    121,
+};
+
+constexpr int32_t lldb_reg_name_slots[] = {
+    23,
+    57,
+    11,
+    77,
+    59,
+    96,
+    104,
+    18,
+    61,
+    15,
+    62,
+    83,
+    124,
+    35,
+    74,
+    46,
+    28,
+    44,
+    4,
+    92,
+    94,
+    80,
+    69,
+    45,
+    111,
+    120,
+    100,
+    79,
+    114,
+    9,
+    25,
+    6,
+    1,
+    89,
+    99,
+    49,
+    123,
+    89,
+    95,
+    91,
+    88,
+    121,
+    81,
+    70,
+    115,
+    86,
+    34,
+    47,
+    41,
+    53,
+    20,
+    106,
+    16,
+    8,
+    17,
+    68,
+    67,
+    50,
+    48,
+    71,
+    84,
+    75,
+    19,
+    64,
+    38,
+    122,
+    60,
+    97,
+    0,
+    105,
+    93,
+    21,
+    40,
+    118,
+    85,
+    30,
+    55,
+    58,
+    82,
+    5,
+    93,
+    36,
+    87,
+    117,
+    39,
+    2,
+    76,
+    14,
+    12,
+    27,
+    119,
+    10,
+    112,
+    26,
+    72,
+    63,
+    125,
+    24,
+    88,
+    29,
+    56,
+    103,
+    108,
+    65,
+    109,
+    13,
+    7,
+    51,
+    87,
+    37,
+    98,
+    54,
+    43,
+    22,
+    31,
+    90,
+    113,
+    102,
+    86,
+    92,
+    3,
+    110,
+    90,
+    78,
+    107,
+    42,
+    52,
+    91,
+    32,
+    116,
+    73,
+    33,
+    66,
+    101,
+};
+
 //
 // GDB Features
 //
@@ -3103,7 +3411,8 @@ namespace ds2 {
 namespace Architecture {
 namespace X86_64 {
 
-LLDBDescriptor const LLDB = {3, lldb_reg_sets};
+LLDBDescriptor const LLDB = {3, lldb_reg_sets, 126, lldb_reg_index, 34,
+                             lldb_reg_name_seeds, 134, lldb_reg_name_slots};
 GDBDescriptor const GDB = {"i386:x86-64", "GNU/Linux", 3, gdb_features};
 }
 }
@@ -15,14 +15,23 @@
 #include "DebugServer2/HardwareBreakpointManager.h"
 #include "DebugServer2/Host/Platform.h"
 #include "DebugServer2/SoftwareBreakpointManager.h"
+#include "DebugServer2/Utils/CRC32.h"
 #include "DebugServer2/Utils/HexValues.h"
 #include "DebugServer2/Utils/Log.h"
 #include "DebugServer2/Utils/Paths.h"
 #include "DebugServer2/Utils/Stringify.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 
+#if defined(OS_POSIX)
+#include <csignal>
+#include <pthread.h>
+#endif
+
 using ds2::Host::Platform;
 using ds2::Utils::Stringify;
 using ds2::Target::Thread;
@@ -30,16 +39,26 @@ using ds2::Target::Thread;
 namespace ds2 {
 namespace GDBRemote {
 
+// Memory kept for qXfer documents between two reads; a large library list
+// is a few hundred kilobytes.
+static size_t const kMaxXferDocumentsSize = 1 << 20;
+
 DebugSessionImplBase::DebugSessionImplBase(StringCollection const &args,
                                            EnvironmentBlock const &env)
-    : DummySessionDelegateImpl(), _resumeSession(nullptr) {
+    : DummySessionDelegateImpl(), _stopSnapshot(),
+      _expeditedRegistersValid(false), _xferStopGeneration(0),
+      _xferDocumentsSize(0), _resumeSession(nullptr), _nonStop(false),
+      _nonStopSession(nullptr) {
   DS2ASSERT(args.size() >= 1);
   _resumeSessionLock.lock();
   spawnProcess(args, env);
 }
 
 DebugSessionImplBase::DebugSessionImplBase(int attachPid)
-    : DummySessionDelegateImpl(), _resumeSession(nullptr) {
+    : DummySessionDelegateImpl(), _stopSnapshot(),
+      _expeditedRegistersValid(false), _xferStopGeneration(0),
+      _xferDocumentsSize(0), _resumeSession(nullptr), _nonStop(false),
+      _nonStopSession(nullptr) {
   _resumeSessionLock.lock();
   _process = ds2::Target::Process::Attach(attachPid);
   if (_process == nullptr)
@@ -47,11 +66,15 @@ DebugSessionImplBase::DebugSessionImplBase(int attachPid)
 }
 
 DebugSessionImplBase::DebugSessionImplBase()
-    : DummySessionDelegateImpl(), _process(nullptr), _resumeSession(nullptr) {
+    : DummySessionDelegateImpl(), _process(nullptr), _stopSnapshot(),
+      _expeditedRegistersValid(false), _xferStopGeneration(0),
+      _xferDocumentsSize(0), _resumeSession(nullptr), _nonStop(false),
+      _nonStopSession(nullptr) {
   _resumeSessionLock.lock();
 }
 
 DebugSessionImplBase::~DebugSessionImplBase() {
+  stopWaitingForEvents();
   _resumeSessionLock.unlock();
   delete _process;
 }
@@ -78,8 +101,12 @@ ErrorCode DebugSessionImplBase::onQuerySupported(
     DS2LOG(Debug, "gdb feature: %s", feature.name.c_str());
   }
 
-  // TODO PacketSize should be respected
-  localFeatures.push_back(std::string("PacketSize=3fff"));
+  // The set of expedited registers may have been renegotiated.
+  _expeditedRegistersValid = false;
+
+  std::ostringstream ss;
+  ss << "PacketSize=" << std::hex << kMaxPacketSize;
+  localFeatures.push_back(ss.str());
   localFeatures.push_back(std::string("QStartNoAckMode+"));
   localFeatures.push_back(std::string("qXfer:features:read+"));
 #if defined(OS_LINUX) || defined(OS_FREEBSD)
@@ -89,6 +116,20 @@ ErrorCode DebugSessionImplBase::onQuerySupported(
   localFeatures.push_back(std::string("qXfer:libraries:read+"));
 #endif
   localFeatures.push_back(std::string("QListThreadsInStopReply+"));
+  localFeatures.push_back(std::string("MultiMemRead+"));
+  localFeatures.push_back(std::string("qMemoryRegions+"));
+#if defined(OS_LINUX)
+  localFeatures.push_back(std::string("qDirtyPages+"));
+#endif
+  if (session.expeditedMemorySize() > 0) {
+    std::ostringstream ss;
+    ss << "ExpeditedMemory=" << std::hex << session.expeditedMemorySize();
+    localFeatures.push_back(ss.str());
+  }
+  localFeatures.push_back(std::string("ExpeditedRegisters+"));
+  if (session.mode() == kCompatibilityModeLLDB) {
+    localFeatures.push_back(std::string("BinaryRegisters+"));
+  }
 
   if (session.mode() != kCompatibilityModeLLDB) {
     localFeatures.push_back(std::string("ConditionalBreakpoints-"));
@@ -149,12 +190,31 @@ DebugSessionImplBase::onProgramSignals(Session &session,
 }
 
 ErrorCode DebugSessionImplBase::onNonStopMode(Session &session, bool enable) {
-  if (enable)
-    return kErrorUnsupported; // TODO support non-stop mode
+  // Without a process, the mode applies to the one we get later on.
+  if (_process != nullptr) {
+    CHK(_process->setNonStop(enable));
+  }
+
+  _nonStop = enable;
+  _stoppedThreads.clear();
+
+  if (enable) {
+    startWaitingForEvents(session);
+  } else {
+    stopWaitingForEvents();
+  }
 
   return kSuccess;
 }
 
+ErrorCode DebugSessionImplBase::onEnableDirtyPageTracking(Session &,
+                                                          bool enable) {
+  if (_process == nullptr)
+    return kErrorProcessNotFound;
+
+  return _process->setDirtyPageTracking(enable);
+}
+
 Thread *DebugSessionImplBase::findThread(ProcessThreadId const &ptid) const {
   if (_process == nullptr)
     return nullptr;
@@ -172,9 +232,30 @@ Thread *DebugSessionImplBase::findThread(ProcessThreadId const &ptid) const {
   return thread;
 }
 
-ErrorCode DebugSessionImplBase::queryStopInfo(Session &session, Thread *thread,
-                                              StopInfo &stop) const {
-  DS2ASSERT(thread != nullptr);
+void DebugSessionImplBase::updateStopSnapshot() const {
+  if (_stopSnapshot.valid &&
+      _stopSnapshot.stopGeneration == _process->stopGeneration())
+    return;
+
+  _stopSnapshot.threads.clear();
+  _stopSnapshot.stops.clear();
+  _process->enumerateThreads(
+      [&](Thread *thread) { _stopSnapshot.threads.insert(thread->tid()); });
+
+  _stopSnapshot.stopGeneration = _process->stopGeneration();
+  _stopSnapshot.valid = true;
+}
+
+// The part of the stop info of a thread that doesn't depend on the session,
+// worked out the first time the thread is asked about at each stop.
+StopInfo const &DebugSessionImplBase::snapshotStopInfo(Thread *thread) const {
+  updateStopSnapshot();
+
+  auto it = _stopSnapshot.stops.find(thread->tid());
+  if (it != _stopSnapshot.stops.end())
+    return it->second;
+
+  StopInfo &stop = _stopSnapshot.stops[thread->tid()];
 
   // Directly copy the fields that are common between ds2::StopInfo and
   // ds2::GDBRemote::StopInfo.
@@ -191,18 +272,14 @@ ErrorCode DebugSessionImplBase::queryStopInfo(Session &session, Thread *thread,
     stop.reason = StopInfo::kReasonNone;
 
   // fall-through from kEventNone.
-  case StopInfo::kEventStop: {
+  case StopInfo::kEventStop:
     // Thread name won't be available if the process has exited or has been
-    // killed.
-    stop.threadName = Platform::GetThreadName(stop.ptid.pid, stop.ptid.tid);
-
-    Architecture::CPUState state;
-    ErrorCode error = thread->readCPUState(state);
-    if (error != kSuccess)
-      return error;
-    state.getStopGPState(stop.registers,
-                         session.mode() == kCompatibilityModeLLDB);
-  } break;
+    // killed. Names are cached by the threads, only the one that reported
+    // the event gets its name read again, it may just have renamed itself.
+    if (thread == _process->currentThread())
+      thread->invalidateName();
+    stop.threadName = thread->name();
+    break;
 
   case StopInfo::kEventExit:
   case StopInfo::kEventKill:
@@ -222,12 +299,213 @@ ErrorCode DebugSessionImplBase::queryStopInfo(Session &session, Thread *thread,
     }
   }
 
-  _process->enumerateThreads(
-      [&](Thread *thread) { stop.threads.insert(thread->tid()); });
+  return stop;
+}
+
+ErrorCode DebugSessionImplBase::readStopInfo(Session &session, Thread *thread,
+                                             StopInfo &stop) const {
+  DS2ASSERT(thread != nullptr);
+
+  // Only happens in non-stop mode.
+  if (thread->state() == Thread::kRunning ||
+      thread->state() == Thread::kStepped)
+    return kErrorBusy;
+
+  stop = snapshotStopInfo(thread);
+  if (stop.event != StopInfo::kEventStop)
+    return kSuccess;
+
+  // Registers may have been written since the stop, they are not part of the
+  // snapshot but the thread caches them.
+  Architecture::CPUState state;
+  ErrorCode error = thread->readCPUState(state);
+  if (error != kSuccess)
+    return error;
+  readExpeditedRegisters(session, state, stop.registers);
+
+  // Only the thread the debugger is going to look at first gets its
+  // memory expedited, other threads would just bloat the reply.
+  if (session.expeditedMemorySize() > 0 &&
+      thread == _process->currentThread()) {
+    readExpeditedMemory(state, session.expeditedMemorySize(), stop.memory);
+  }
+
+  return kSuccess;
+}
+
+ErrorCode DebugSessionImplBase::queryStopInfo(Session &session, Thread *thread,
+                                              StopInfo &stop) const {
+  CHK(readStopInfo(session, thread, stop));
+
+  stop.threads = _stopSnapshot.threads;
+
+  // When the debugger wants the thread list, the thread it is going to look
+  // at first also gets the PC and stop state of all threads so that it
+  // doesn't query them one by one. Queries for other threads stay O(1).
+  if (!session.threadsInStopReply() || thread != _process->currentThread())
+    return kSuccess;
+
+  for (auto tid : _stopSnapshot.threads) {
+    Thread *other = _process->thread(tid);
+    if (other == nullptr)
+      continue;
+
+    Architecture::CPUState state;
+    if (other->readCPUState(state) == kSuccess) {
+      stop.threadPCs[tid] = state.pc();
+    }
+    if (other->stopInfo().reason != StopInfo::kReasonNone) {
+      stop.threadStops[tid] = other->stopInfo();
+    }
+  }
 
   return kSuccess;
 }
 
+// Registers the debugger needs to unwind the stack, which is all that the
+// "generic" set of expedited registers holds. The register definitions call
+// the return address register "lr".
+static bool IsGenericRegister(Architecture::LLDBDescriptor const &desc,
+                              size_t regno, bool forLLDB) {
+  static char const *const kGenericNames[] = {"pc", "sp", "fp", "lr"};
+
+  for (size_t nset = 0; nset < desc.Count; nset++) {
+    Architecture::LLDBRegisterSet const *set = desc.Sets[nset];
+    for (size_t n = 0; n < set->Count; n++) {
+      Architecture::RegisterDef const *def = set->Defs[n];
+      int32_t number =
+          forLLDB ? def->LLDBRegisterNumber : def->GDBRegisterNumber;
+      if (number < 0 || static_cast<size_t>(number) != regno)
+        continue;
+
+      if (def->GenericName == nullptr)
+        return false;
+      for (char const *name : kGenericNames) {
+        if (std::strcmp(def->GenericName, name) == 0)
+          return true;
+      }
+      return false;
+    }
+  }
+
+  return false;
+}
+
+static uint64_t ReadRegisterValue(uint8_t const *ptr, size_t size) {
+  switch (size) {
+  case sizeof(uint8_t):
+    return *ptr;
+  case sizeof(uint16_t): {
+    uint16_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+  }
+  case sizeof(uint32_t): {
+    uint32_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+  }
+  default: {
+    uint64_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+  }
+  }
+}
+
+void DebugSessionImplBase::readExpeditedRegisters(
+    Session &session, Architecture::CPUState const &state,
+    Architecture::GPRegisterStopMap &regs) const {
+  bool forLLDB = (session.mode() == kCompatibilityModeLLDB);
+  auto base = reinterpret_cast<uint8_t const *>(&state);
+
+  if (!_expeditedRegistersValid) {
+    Architecture::LLDBDescriptor const *desc =
+        _process->getLLDBRegistersDescriptor();
+    Architecture::GPRegisterStopMap candidates;
+    state.getStopGPState(candidates, forLLDB);
+
+    _expeditedRegisters.clear();
+    for (auto const &reg : candidates) {
+      switch (session.expeditedRegisters()) {
+      case Session::kExpediteAllRegisters:
+        break;
+      case Session::kExpediteGenericRegisters:
+        if (!IsGenericRegister(*desc, reg.first, forLLDB))
+          continue;
+        break;
+      case Session::kExpediteListedRegisters:
+        if (session.expeditedRegisterList().count(reg.first) == 0)
+          continue;
+        break;
+      }
+
+      void *ptr;
+      size_t length;
+      bool success = forLLDB
+                         ? state.getLLDBRegisterPtr(reg.first, &ptr, &length)
+                         : state.getGDBRegisterPtr(reg.first, &ptr, &length);
+      if (!success || length > sizeof(uint64_t))
+        continue;
+
+      _expeditedRegisters.push_back(ExpeditedRegister{
+          reg.first, static_cast<size_t>(static_cast<uint8_t *>(ptr) - base),
+          length});
+    }
+
+    _expeditedRegistersValid = true;
+  }
+
+  for (auto const &reg : _expeditedRegisters) {
+    regs[reg.regno] = Architecture::GPRegisterValue{
+        reg.size, ReadRegisterValue(base + reg.offset, reg.size)};
+  }
+}
+
+// Send the bytes around PC and at the top of the stack, as well as the frame
+// records of the first few frames, which is what the debugger reads right
+// after a stop to disassemble and unwind.
+void DebugSessionImplBase::readExpeditedMemory(
+    Architecture::CPUState const &state, size_t size,
+    std::map<uint64_t, ByteVector> &memory) const {
+  static size_t const kMaxExpeditedFrames = 16;
+
+  ProcessInfo info;
+  if (_process->getInfo(info) != kSuccess)
+    return;
+
+  size_t pointerSize = info.pointerSize;
+  if (pointerSize != 4 && pointerSize != 8)
+    return;
+
+  ByteVector buffer;
+  if (_process->readMemoryBuffer(state.pc(), size, buffer) == kSuccess) {
+    memory[state.pc()] = buffer;
+  }
+  if (_process->readMemoryBuffer(state.sp(), size, buffer) == kSuccess) {
+    memory[state.sp()] = buffer;
+  }
+
+  // Each frame record is the saved frame pointer followed by the return
+  // address; stop as soon as the chain stops going up the stack.
+  uint64_t fp = state.fp();
+  for (size_t n = 0; n < kMaxExpeditedFrames && fp != 0; n++) {
+    if (_process->readMemoryBuffer(fp, 2 * pointerSize, buffer) != kSuccess ||
+        buffer.size() != 2 * pointerSize)
+      break;
+
+    uint64_t next = 0;
+    for (size_t i = pointerSize; i > 0; i--) {
+      next = (next << 8) | buffer[i - 1];
+    }
+
+    memory[fp] = buffer;
+    if (next <= fp)
+      break;
+    fp = next;
+  }
+}
+
 ErrorCode DebugSessionImplBase::queryStopInfo(Session &session,
                                               ProcessThreadId const &ptid,
                                               StopInfo &stop) const {
@@ -254,11 +532,12 @@ ErrorCode DebugSessionImplBase::onQueryThreadList(Session &, ProcessId pid,
   if (_process == nullptr)
     return kErrorProcessNotFound;
 
-  std::vector<ThreadId> tids;
-
   if (lastTid == kAllThreadId) {
-    _process->getThreadIds(tids);
-    _threadIterationState.vals = tids;
+    // The list comes from the stop snapshot, a thread exiting under us
+    // cannot invalidate an iteration in progress.
+    updateStopSnapshot();
+    _threadIterationState.vals.assign(_stopSnapshot.threads.begin(),
+                                      _stopSnapshot.threads.end());
     _threadIterationState.it = _threadIterationState.vals.begin();
   } else if (lastTid != kAnyThreadId) {
     return kErrorInvalidArgument;
@@ -346,6 +625,7 @@ ErrorCode DebugSessionImplBase::onQueryRegisterInfo(Session &, uint32_t regno,
   if (!Architecture::LLDBGetRegisterInfo(*desc, regno, reginfo))
     return kErrorInvalidArgument;
 
+  info.setName.clear();
   if (reginfo.SetName != nullptr) {
     info.setName = reginfo.SetName;
   }
@@ -356,9 +636,12 @@ ErrorCode DebugSessionImplBase::onQueryRegisterInfo(Session &, uint32_t regno,
     info.registerName = reginfo.Def->Name;
   }
 
+  info.alternateName.clear();
   if (reginfo.Def->AlternateName != nullptr) {
     info.alternateName = reginfo.Def->AlternateName;
   }
+
+  info.genericName.clear();
   if (reginfo.Def->GenericName != nullptr) {
     info.genericName = reginfo.Def->GenericName;
   }
@@ -454,6 +737,28 @@ ErrorCode DebugSessionImplBase::onQueryRegisterInfo(Session &, uint32_t regno,
   return kSuccess;
 }
 
+ErrorCode DebugSessionImplBase::onQueryResponseScope(Session &session,
+                                                     ResponseScope scope,
+                                                     std::string &key) const {
+  if (scope == kResponseScopeHost)
+    return DummySessionDelegateImpl::onQueryResponseScope(session, scope, key);
+
+  if (_process == nullptr)
+    return kErrorProcessNotFound;
+
+  std::ostringstream ss;
+  if (scope == kResponseScopeRegisters) {
+    // The descriptors are static tables, their addresses name the layout.
+    ss << _process->getGDBRegistersDescriptor() << ':'
+       << _process->getLLDBRegistersDescriptor();
+  } else {
+    ss << _process->imageGeneration();
+  }
+
+  key = ss.str();
+  return kSuccess;
+}
+
 ErrorCode DebugSessionImplBase::onQuerySharedLibrariesInfoAddress(
     Session &, Address &address) const {
   if (_process == nullptr) {
@@ -487,21 +792,17 @@ ErrorCode DebugSessionImplBase::onQueryFileLoadAddress(
   return kSuccess;
 }
 
-ErrorCode DebugSessionImplBase::onXferRead(Session &session,
-                                           std::string const &object,
-                                           std::string const &annex,
-                                           uint64_t offset, uint64_t length,
-                                           std::string &buffer, bool &last) {
-  DS2LOG(Debug, "object='%s' annex='%s' offset=%#" PRIx64 " length=%#" PRIx64,
-         object.c_str(), annex.c_str(), offset, length);
-
+ErrorCode DebugSessionImplBase::generateXferDocument(Session &session,
+                                                     std::string const &object,
+                                                     std::string const &annex,
+                                                     std::string &buffer) {
   // TODO Split these generators into appropriate functions
   if (object == "features") {
     if (session.mode() == kCompatibilityModeLLDB) {
       Architecture::LLDBDescriptor const *desc =
           _process->getLLDBRegistersDescriptor();
       if (annex == "target.xml") {
-        buffer = Architecture::LLDBGenerateXMLMain(*desc).substr(offset);
+        buffer = Architecture::LLDBGenerateXMLMain(*desc);
       } else {
         std::ostringstream ss;
         ss << Architecture::GenerateXMLHeader();
@@ -521,40 +822,44 @@ ErrorCode DebugSessionImplBase::onXferRead(Session &session,
           ss << '\t' << info.encode(setNum) << '\n';
         }
         ss << "</feature>" << std::endl;
-        buffer = ss.str().substr(offset);
+        buffer = ss.str();
       }
     } else {
       Architecture::GDBDescriptor const *desc =
           _process->getGDBRegistersDescriptor();
       if (annex == "target.xml") {
-        buffer = Architecture::GDBGenerateXMLMain(*desc).substr(offset);
+        buffer = Architecture::GDBGenerateXMLMain(*desc);
       } else {
-        buffer = Architecture::GDBGenerateXMLFeatureByFileName(*desc, annex)
-                     .substr(offset);
+        buffer = Architecture::GDBGenerateXMLFeatureByFileName(*desc, annex);
       }
     }
   } else if (object == "auxv") {
     ErrorCode error = _process->getAuxiliaryVector(buffer);
     if (error != kSuccess)
       return error;
-
-    buffer = buffer.substr(offset);
   } else if (object == "threads") {
     std::ostringstream ss;
 
     ss << "<threads>" << std::endl;
 
-    _process->enumerateThreads([&](Thread *thread) {
+    updateStopSnapshot();
+    for (auto tid : _stopSnapshot.threads) {
+      Thread *thread = _process->thread(tid);
+      if (thread == nullptr)
+        continue;
+
+      // Cores are not tracked from debug events, ask the system.
+      thread->reconcileState();
       ss << "<thread "
          << "id=\"p" << std::hex << _process->pid() << '.' << std::hex
          << thread->tid() << "\" "
          << "core=\"" << std::dec << thread->core() << "\""
          << "/>" << std::endl;
-    });
+    }
 
     ss << "</threads>" << std::endl;
 
-    buffer = ss.str().substr(offset);
+    buffer = ss.str();
   } else if (object == "libraries") {
     std::ostringstream ss;
 
@@ -574,7 +879,7 @@ ErrorCode DebugSessionImplBase::onXferRead(Session &session,
     });
 
     ss << "</library-list>";
-    buffer = ss.str().substr(offset);
+    buffer = ss.str();
   } else if (object == "libraries-svr4") {
     std::ostringstream ss;
     std::ostringstream sslibs;
@@ -604,14 +909,67 @@ ErrorCode DebugSessionImplBase::onXferRead(Session &session,
     ss << ">" << std::endl;
     ss << sslibs.str();
     ss << "</library-list-svr4>";
-    buffer = ss.str().substr(offset);
+    buffer = ss.str();
   } else {
     return kErrorUnsupported;
   }
 
-  if (buffer.length() > length) {
-    buffer.resize(length);
-    last = false;
+  return kSuccess;
+}
+
+ErrorCode DebugSessionImplBase::onXferRead(Session &session,
+                                           std::string const &object,
+                                           std::string const &annex,
+                                           uint64_t offset, uint64_t length,
+                                           std::string &buffer, bool &last) {
+  DS2LOG(Debug, "object='%s' annex='%s' offset=%#" PRIx64 " length=%#" PRIx64,
+         object.c_str(), annex.c_str(), offset, length);
+
+  if (_process == nullptr)
+    return kErrorProcessNotFound;
+
+  if (_xferStopGeneration != _process->stopGeneration()) {
+    _xferDocuments.clear();
+    _xferDocumentsSize = 0;
+    _xferStopGeneration = _process->stopGeneration();
+  }
+
+  // Debuggers read documents from the start and then in order, so a read at
+  // offset 0 regenerates the document and the following ones get slices of
+  // it. Documents that would not fit are regenerated for every slice.
+  std::string key = object + ':' + annex;
+  auto it = _xferDocuments.find(key);
+  std::string document;
+
+  if (offset == 0 || it == _xferDocuments.end()) {
+    if (it != _xferDocuments.end()) {
+      _xferDocumentsSize -= it->second.size();
+      _xferDocuments.erase(it);
+    }
+
+    CHK(generateXferDocument(session, object, annex, document));
+
+    if (_xferDocumentsSize + document.size() > kMaxXferDocumentsSize) {
+      _xferDocuments.clear();
+      _xferDocumentsSize = 0;
+    }
+    if (document.size() <= kMaxXferDocumentsSize) {
+      _xferDocumentsSize += document.size();
+      it = _xferDocuments.insert(std::make_pair(key, document)).first;
+    } else {
+      it = _xferDocuments.end();
+    }
+  }
+
+  std::string const &data =
+      (it != _xferDocuments.end()) ? it->second : document;
+
+  if (offset >= data.size()) {
+    buffer.clear();
+    last = true;
+  } else {
+    buffer = data.substr(offset, length);
+    last = (offset + buffer.size() >= data.size());
   }
 
   return kSuccess;
@@ -678,6 +1036,97 @@ ErrorCode DebugSessionImplBase::onWriteGeneralRegisters(
 
   state.setGPState(regs);
 
+  return thread->writeCPURegisterSets(state, Architecture::kRegisterSetGP);
+}
+
+// Registers making up the context sent by g and G in LLDB mode, which are
+// the ones with an offset in qRegisterInfo. Registers living inside another
+// one (eax in rax, xmm0 in ymm0) are covered by their container.
+template <typename FunctionType>
+static void EnumerateContextRegisters(Architecture::LLDBDescriptor const &desc,
+                                      FunctionType const &cb) {
+  for (size_t nset = 0; nset < desc.Count; nset++) {
+    Architecture::LLDBRegisterSet const *set = desc.Sets[nset];
+    for (size_t n = 0; n < set->Count; n++) {
+      Architecture::RegisterDef const *def = set->Defs[n];
+      if (def->LLDBOffset < 0 || def->BitSize <= 0 ||
+          def->LLDBRegisterNumber < 0)
+        continue;
+      if (def->ContainerRegisters != nullptr &&
+          def->ContainerRegisters[0] != nullptr)
+        continue;
+
+      cb(def, static_cast<size_t>(def->LLDBOffset),
+         static_cast<size_t>(def->BitSize) / 8);
+    }
+  }
+}
+
+ErrorCode DebugSessionImplBase::onReadAllRegisters(Session &,
+                                                   ProcessThreadId const &ptid,
+                                                   ByteVector &context) {
+  Thread *thread = findThread(ptid);
+  if (thread == nullptr)
+    return kErrorProcessNotFound;
+
+  Architecture::CPUState state;
+  ErrorCode error =
+      thread->readCPURegisterSets(state, Architecture::kRegisterSetAll);
+  if (error != kSuccess)
+    return error;
+
+  context.clear();
+  EnumerateContextRegisters(
+      *_process->getLLDBRegistersDescriptor(),
+      [&](Architecture::RegisterDef const *def, size_t offset, size_t size) {
+        if (context.size() < offset + size) {
+          context.resize(offset + size, 0);
+        }
+
+        void *ptr;
+        size_t length;
+        if (state.getLLDBRegisterPtr(def->LLDBRegisterNumber, &ptr, &length)) {
+          std::memcpy(&context[offset], ptr, std::min(length, size));
+        }
+      });
+
+  return kSuccess;
+}
+
+ErrorCode DebugSessionImplBase::onWriteAllRegisters(Session &,
+                                                    ProcessThreadId const &ptid,
+                                                    ByteVector const &context) {
+  Thread *thread = findThread(ptid);
+  if (thread == nullptr)
+    return kErrorProcessNotFound;
+
+  Architecture::CPUState state;
+  ErrorCode error =
+      thread->readCPURegisterSets(state, Architecture::kRegisterSetAll);
+  if (error != kSuccess)
+    return error;
+
+  Architecture::LLDBDescriptor const *desc =
+      _process->getLLDBRegistersDescriptor();
+
+  size_t contextSize = 0;
+  EnumerateContextRegisters(*desc, [&](Architecture::RegisterDef const *,
+                                       size_t offset, size_t size) {
+    contextSize = std::max(contextSize, offset + size);
+  });
+  if (context.size() != contextSize)
+    return kErrorInvalidArgument;
+
+  EnumerateContextRegisters(
+      *desc,
+      [&](Architecture::RegisterDef const *def, size_t offset, size_t size) {
+        void *ptr;
+        size_t length;
+        if (state.getLLDBRegisterPtr(def->LLDBRegisterNumber, &ptr, &length)) {
+          std::memcpy(ptr, &context[offset], std::min(length, size));
+        }
+      });
+
   return thread->writeCPUState(state);
 }
 
@@ -691,7 +1140,8 @@ ErrorCode DebugSessionImplBase::onSaveRegisters(Session &session,
     return kErrorProcessNotFound;
 
   Architecture::CPUState state;
-  ErrorCode error = thread->readCPUState(state);
+  ErrorCode error =
+      thread->readCPURegisterSets(state, Architecture::kRegisterSetAll);
   if (error != kSuccess)
     return error;
 
@@ -746,6 +1196,15 @@ ErrorCode DebugSessionImplBase::onReadRegisterValue(Session &session,
   if (!success)
     return kErrorInvalidArgument;
 
+  // Floating point and vector registers are only fetched on first access;
+  // |ptr| stays valid as it points inside |state|.
+  uint32_t sets = state.registerSetsOf(ptr, length);
+  if ((state.validSets & sets) != sets) {
+    error = thread->readCPURegisterSets(state, sets);
+    if (error != kSuccess)
+      return error;
+  }
+
   value.insert(value.end(), reinterpret_cast<char *>(ptr),
                reinterpret_cast<char *>(ptr) + length);
 
@@ -777,12 +1236,20 @@ ErrorCode DebugSessionImplBase::onWriteRegisterValue(
   if (!success)
     return kErrorInvalidArgument;
 
+  // Fetch the rest of the register set before modifying it.
+  uint32_t sets = state.registerSetsOf(ptr, length);
+  if ((state.validSets & sets) != sets) {
+    error = thread->readCPURegisterSets(state, sets);
+    if (error != kSuccess)
+      return error;
+  }
+
   if (value.length() != length)
     return kErrorInvalidArgument;
 
   std::memcpy(ptr, value.c_str(), length);
 
-  return thread->writeCPUState(state);
+  return thread->writeCPURegisterSets(state, sets);
 }
 
 ErrorCode DebugSessionImplBase::onReadMemory(Session &, Address const &address,
@@ -793,6 +1260,37 @@ ErrorCode DebugSessionImplBase::onReadMemory(Session &, Address const &address,
     return _process->readMemoryBuffer(address, length, data);
 }
 
+ErrorCode DebugSessionImplBase::onReadMemoryRanges(
+    Session &, std::vector<std::pair<Address, size_t>> const &ranges,
+    std::vector<ByteVector> &data) {
+  if (_process == nullptr)
+    return kErrorProcessNotFound;
+
+  // Ranges that can't be read are reported as empty instead of failing the
+  // whole request; neighbouring ranges are served from the memory cache.
+  data.resize(ranges.size());
+  for (size_t n = 0; n < ranges.size(); n++) {
+    if (_process->readMemoryBuffer(ranges[n].first, ranges[n].second,
+                                   data[n]) != kSuccess) {
+      data[n].clear();
+    }
+  }
+
+  return kSuccess;
+}
+
+ErrorCode DebugSessionImplBase::onQueryDirtyPages(Session &,
+                                                  Address const &address,
+                                                  size_t length,
+                                                  size_t &pageSize,
+                                                  std::vector<bool> &dirty) {
+  if (_process == nullptr)
+    return kErrorProcessNotFound;
+
+  pageSize = Platform::GetPageSize();
+  return _process->getDirtyPages(address, length, dirty);
+}
+
 ErrorCode DebugSessionImplBase::onWriteMemory(Session &, Address const &address,
                                               ByteVector const &data,
                                               size_t &nwritten) {
@@ -837,6 +1335,147 @@ DebugSessionImplBase::onQueryMemoryRegionInfo(Session &, Address const &address,
     return _process->getMemoryRegionInfo(address, info);
 }
 
+ErrorCode DebugSessionImplBase::onComputeCRC(Session &, Address const &address,
+                                             size_t length, uint32_t &crc) {
+  static size_t const kCRCChunkSize = 0x100000;
+
+  if (_process == nullptr)
+    return kErrorProcessNotFound;
+
+  uint64_t start = address;
+  ByteVector buffer;
+
+  crc = 0xffffffff;
+  while (length > 0) {
+    size_t size = std::min(length, kCRCChunkSize);
+    CHK(_process->readMemoryBuffer(start, size, buffer));
+    if (buffer.size() < size)
+      return kErrorInvalidAddress;
+
+    crc = Utils::CRC32(buffer.data(), buffer.size(), crc);
+    start += size, length -= size;
+  }
+
+  return kSuccess;
+}
+
+// Memory searches are done in chunks of this size so that large ranges are
+// scanned on the target instead of being transferred to the debugger.
+static size_t const kSearchChunkSize = 0x10000;
+
+static uint8_t const *FindPattern(uint8_t const *first, uint8_t const *last,
+                                  uint8_t const *pattern, size_t length) {
+  // memchr is vectorized by the C library; only verify the rest of the
+  // pattern where the first byte matches.
+  while (static_cast<size_t>(last - first) >= length) {
+    first = static_cast<uint8_t const *>(
+        std::memchr(first, pattern[0], (last - first) - length + 1));
+    if (first == nullptr)
+      return nullptr;
+    if (std::memcmp(first + 1, pattern + 1, length - 1) == 0)
+      return first;
+    first++;
+  }
+
+  return nullptr;
+}
+
+ErrorCode DebugSessionImplBase::onSearch(Session &, Address const &address,
+                                         size_t length,
+                                         std::string const &pattern,
+                                         Address &location) {
+  if (_process == nullptr)
+    return kErrorProcessNotFound;
+
+  if (pattern.empty())
+    return kErrorInvalidArgument;
+
+  uint64_t start = address;
+  uint64_t end =
+      start +
+      std::min<uint64_t>(length, std::numeric_limits<uint64_t>::max() - start);
+  auto needle = reinterpret_cast<uint8_t const *>(pattern.data());
+
+  // Consecutive chunks overlap by the size of the pattern minus one byte so
+  // that matches straddling two chunks are found.
+  size_t overlap = pattern.size() - 1;
+  ByteVector buffer;
+
+  while (end - start >= pattern.size()) {
+    size_t size = std::min<uint64_t>(kSearchChunkSize + overlap, end - start);
+    CHK(_process->readMemoryBuffer(start, size, buffer));
+
+    uint8_t const *match = FindPattern(
+        buffer.data(), buffer.data() + buffer.size(), needle, pattern.size());
+    if (match != nullptr) {
+      location = start + (match - buffer.data());
+      return kSuccess;
+    }
+
+    // A short read means we reached memory we can't access.
+    if (buffer.size() < size)
+      return kErrorInvalidAddress;
+
+    start += size - overlap;
+  }
+
+  return kErrorNotFound;
+}
+
+ErrorCode DebugSessionImplBase::onSearchBackward(Session &,
+                                                 Address const &address,
+                                                 uint32_t pattern,
+                                                 uint32_t mask,
+                                                 Address &location) {
+  if (_process == nullptr)
+    return kErrorProcessNotFound;
+
+  uint64_t const pageSize = Platform::GetPageSize();
+  uint32_t const value = pattern & mask;
+
+  // `end` is one past the last byte of the highest candidate word; chunks
+  // overlap by three bytes so that words straddling two chunks are checked.
+  uint64_t end = address.value() +
+                 std::min<uint64_t>(sizeof(pattern),
+                                    std::numeric_limits<uint64_t>::max() -
+                                        address.value());
+  ByteVector buffer;
+
+  while (end >= sizeof(pattern)) {
+    uint64_t start = end > kSearchChunkSize ? end - kSearchChunkSize : 0;
+    ErrorCode error = _process->readMemoryBuffer(start, end - start, buffer);
+
+    // The bottom of the chunk may not be mapped; retry with only the page
+    // holding the highest candidate and stop once that isn't readable either.
+    if (error != kSuccess || buffer.size() < end - start) {
+      uint64_t pageStart = (end - sizeof(pattern)) & ~(pageSize - 1);
+      if (pageStart <= start)
+        return kErrorNotFound;
+      start = pageStart;
+      error = _process->readMemoryBuffer(start, end - start, buffer);
+      if (error != kSuccess || buffer.size() < end - start)
+        return kErrorNotFound;
+    }
+
+    if (buffer.size() >= sizeof(pattern)) {
+      for (size_t n = buffer.size() - sizeof(pattern) + 1; n-- > 0;) {
+        uint32_t word;
+        std::memcpy(&word, &buffer[n], sizeof(word));
+        if ((word & mask) == value) {
+          location = start + n;
+          return kSuccess;
+        }
+      }
+    }
+
+    if (start == 0)
+      break;
+    end = start + sizeof(pattern) - 1;
+  }
+
+  return kErrorNotFound;
+}
+
 ErrorCode
 DebugSessionImplBase::onSetProgramArguments(Session &,
                                             StringCollection const &args) {
@@ -862,10 +1501,16 @@ ErrorCode DebugSessionImplBase::onAttach(Session &session, ProcessId pid,
 
   DS2LOG(Info, "attaching to pid %" PRIu64, (uint64_t)pid);
   _process = Target::Process::Attach(pid);
+  _stopSnapshot.valid = false;
+  _expeditedRegistersValid = false;
   if (_process == nullptr) {
     return kErrorProcessNotFound;
   }
 
+  if (_nonStop) {
+    CHK(_process->setNonStop(true));
+  }
+
   return queryStopInfo(session, pid, stop);
 }
 
@@ -878,6 +1523,9 @@ DebugSessionImplBase::onResume(Session &session,
   bool hasGlobalAction = false;
   std::set<Thread *> excluded;
 
+  if (_process->nonStop())
+    return resumeThreads(actions);
+
   DS2ASSERT(_resumeSession == nullptr);
   _resumeSession = &session;
   _resumeSessionLock.unlock();
@@ -1035,6 +1683,129 @@ ret:
   return error;
 }
 
+// In non-stop mode, each thread follows the first action that applies to it
+// and the threads that no action applies to are left as they are. Threads
+// that stop are reported later on, see onQueryStopEvent.
+ErrorCode DebugSessionImplBase::resumeThreads(
+    ThreadResumeAction::Collection const &actions) {
+  // Backward execution and cycle steps have no per-thread equivalent.
+  for (auto const &action : actions) {
+    switch (action.action) {
+    case kResumeActionContinue:
+    case kResumeActionContinueWithSignal:
+    case kResumeActionSingleStep:
+    case kResumeActionSingleStepWithSignal:
+    case kResumeActionStop:
+      break;
+    default:
+      return kErrorUnsupported;
+    }
+  }
+
+  std::set<Thread *> handled;
+
+  for (auto const &action : actions) {
+    std::vector<Thread *> threads;
+    if (action.ptid.validTid()) {
+      Thread *thread = findThread(action.ptid);
+      if (thread == nullptr) {
+        DS2LOG(Warning, "pid %" PRIu64 " tid %" PRIu64 " not found",
+               (uint64_t)action.ptid.pid, (uint64_t)action.ptid.tid);
+        continue;
+      }
+      threads.push_back(thread);
+    } else {
+      _process->enumerateThreads(
+          [&](Thread *thread) { threads.push_back(thread); });
+    }
+
+    for (auto thread : threads) {
+      if (!handled.insert(thread).second)
+        continue;
+
+      ErrorCode error;
+      switch (action.action) {
+      case kResumeActionContinue:
+      case kResumeActionContinueWithSignal:
+      case kResumeActionSingleStep:
+      case kResumeActionSingleStepWithSignal:
+        if (thread->state() != Thread::kStopped)
+          continue;
+
+        error = _process->beforeThreadResume(thread);
+        if (error != kSuccess)
+          break;
+
+        if (action.action == kResumeActionSingleStep ||
+            action.action == kResumeActionSingleStepWithSignal) {
+          error = thread->step(action.signal, action.address);
+        } else {
+          error = thread->resume(action.signal, action.address);
+        }
+        break;
+
+      case kResumeActionStop:
+        if (thread->state() != Thread::kRunning)
+          continue;
+
+        error = thread->suspend();
+        if (error == kSuccess) {
+          error = _process->afterThreadStop(thread);
+          _stoppedThreads.push_back(thread->tid());
+        }
+        break;
+
+      default:
+        DS2_UNREACHABLE();
+      }
+
+      if (error != kSuccess) {
+        DS2LOG(Warning,
+               "cannot apply action %d to pid %" PRIu64 " tid %" PRIu64
+               ", error=%s",
+               action.action, (uint64_t)_process->pid(),
+               (uint64_t)thread->tid(), Stringify::Error(error));
+      }
+    }
+  }
+
+  return kSuccess;
+}
+
+ErrorCode DebugSessionImplBase::onQueryStopEvent(Session &session,
+                                                 StopInfo &stop) {
+  if (_process == nullptr || !_process->nonStop())
+    return kErrorNotFound;
+
+  //
+  // Threads we stopped on request come first, they stopped before anything
+  // wait can still find.
+  //
+  Thread *thread = nullptr;
+  while (thread == nullptr && !_stoppedThreads.empty()) {
+    thread = _process->thread(_stoppedThreads.front());
+    _stoppedThreads.pop_front();
+  }
+
+  if (thread == nullptr) {
+    if (!_process->isAlive())
+      return kErrorNotFound;
+
+    CHK(_process->wait());
+    thread = _process->currentThread();
+    CHK(_process->afterThreadStop(thread));
+  }
+
+  CHK(queryStopInfo(session, thread, stop));
+
+  if (stop.event == StopInfo::kEventExit ||
+      stop.event == StopInfo::kEventKill) {
+    _spawner.flushAndExit();
+  }
+
+  return kSuccess;
+}
+
 ErrorCode DebugSessionImplBase::onDetach(Session &, ProcessId, bool stopped) {
   ErrorCode error;
 
@@ -1043,7 +1814,8 @@ ErrorCode DebugSessionImplBase::onDetach(Session &, ProcessId, bool stopped) {
     bpm->clear();
   }
 
-  if (stopped) {
+  // Threads can only be detached from while they are stopped.
+  if (stopped || _process->nonStop()) {
     error = _process->suspend();
     if (error != kSuccess)
       return error;
@@ -1063,12 +1835,19 @@ ErrorCode DebugSessionImplBase::onTerminate(Session &session,
     return error;
   }
 
+  // Wait for the process to be gone rather than poll for it.
+  if (_process->nonStop()) {
+    _process->setNonStop(false);
+  }
+
   error = _process->wait();
   if (error != kSuccess) {
     DS2LOG(Error, "couldn't wait for process termination");
     return error;
   }
 
+  // The threads didn't go through a resume to get here.
+  _stopSnapshot.valid = false;
   return queryStopInfo(session, _process->currentThread(), stop);
 }
 
@@ -1171,6 +1950,8 @@ ErrorCode DebugSessionImplBase::spawnProcess(StringCollection const &args,
       DS2LOG(Debug, "  %s", arg.c_str());
   }
 
+  _stopSnapshot.valid = false;
+  _expeditedRegistersValid = false;
   _spawner.setExecutable(args[0]);
   _spawner.setArguments(StringCollection(args.begin() + 1, args.end()));
 
@@ -1196,6 +1977,10 @@ ErrorCode DebugSessionImplBase::spawnProcess(StringCollection const &args,
     return kErrorUnknown;
   }
 
+  if (_nonStop) {
+    CHK(_process->setNonStop(true));
+  }
+
   return kSuccess;
 }
 
@@ -1203,6 +1988,20 @@ void DebugSessionImplBase::appendOutput(char const *buf, size_t size) {
   for (size_t i = 0; i < size; ++i) {
     this->_consoleBuffer += buf[i];
     if (buf[i] == '\n') {
+      //
+      // In non-stop mode the inferior runs while we serve the debugger, the
+      // session is busy on the main thread; have it send the output.
+      //
+      if (_nonStop) {
+        std::lock_guard<std::mutex> guard(_nonStopLock);
+        _pendingOutput.push_back(_consoleBuffer);
+        _consoleBuffer.clear();
+        if (_nonStopSession != nullptr) {
+          _nonStopSession->wake();
+        }
+        continue;
+      }
+
       _resumeSessionLock.lock();
       DS2ASSERT(_resumeSession != nullptr);
       std::string data = "O";
@@ -1214,6 +2013,69 @@ void DebugSessionImplBase::appendOutput(char const *buf, size_t size) {
   }
 }
 
+ErrorCode DebugSessionImplBase::onQueryOutput(Session &,
+                                              std::string &output) {
+  std::lock_guard<std::mutex> guard(_nonStopLock);
+  if (_pendingOutput.empty())
+    return kErrorNotFound;
+
+  output = std::move(_pendingOutput.front());
+  _pendingOutput.pop_front();
+  return kSuccess;
+}
+
+void DebugSessionImplBase::startWaitingForEvents(Session &session) {
+  std::lock_guard<std::mutex> guard(_nonStopLock);
+  _nonStopSession = &session;
+
+#if defined(OS_POSIX)
+  if (!_eventThread.joinable()) {
+    _eventThread = std::thread(&DebugSessionImplBase::waitForEvents, this);
+  }
+#endif
+}
+
+void DebugSessionImplBase::stopWaitingForEvents() {
+  {
+    std::lock_guard<std::mutex> guard(_nonStopLock);
+    _nonStopSession = nullptr;
+  }
+
+#if defined(OS_POSIX)
+  if (_eventThread.joinable()) {
+    ::pthread_kill(_eventThread.native_handle(), SIGCHLD);
+    _eventThread.join();
+  }
+#endif
+}
+
+//
+// The process tells us about stopped threads with SIGCHLD, which every thread
+// keeps blocked (see Platform::Initialize) so that it stays pending until we
+// take it here. We only wake the session up: the main thread is the tracer
+// and collects the stops itself, see onQueryStopEvent. stopWaitingForEvents
+// sends us a SIGCHLD of our own to have us return.
+//
+void DebugSessionImplBase::waitForEvents() {
+#if defined(OS_POSIX)
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, SIGCHLD);
+
+  for (;;) {
+    int signal;
+    if (::sigwait(&set, &signal) != 0)
+      continue;
+
+    std::lock_guard<std::mutex> guard(_nonStopLock);
+    if (_nonStopSession == nullptr)
+      break;
+
+    _nonStopSession->wake();
+  }
+#endif
+}
+
 ErrorCode DebugSessionImplBase::onSendInput(Session &session,
                                             ByteVector const &buf) {
   return _spawner.input(buf);
@@ -1228,8 +2090,12 @@ ErrorCode DebugSessionImplBase::fetchStopInfoForAllThreads(
   }
 
   for (auto const &tid : processStop.threads) {
+    Thread *thread = _process->thread(tid);
+    if (thread == nullptr)
+      continue;
+
     StopInfo stop;
-    onQueryThreadStopInfo(session, ProcessThreadId(kAnyProcessId, tid), stop);
+    readStopInfo(session, thread, stop);
     stops.push_back(stop);
   }
 
@@ -1239,14 +2105,22 @@ ErrorCode DebugSessionImplBase::fetchStopInfoForAllThreads(
 ErrorCode
 DebugSessionImplBase::createThreadsStopInfo(Session &session,
                                             JSArray &threadsStopInfo) {
-  StopInfo processStop;
-  std::vector<StopInfo> stops;
-  ErrorCode error = fetchStopInfoForAllThreads(session, stops, processStop);
-  if (error != kSuccess) {
-    return error;
-  }
+  if (_process == nullptr)
+    return kErrorProcessNotFound;
+
+  // Like debugserver, only describe the threads that stopped for a reason;
+  // the others are in the thread list already and this goes in every
+  // qThreadStopInfo reply.
+  updateStopSnapshot();
+  for (auto tid : _stopSnapshot.threads) {
+    Thread *thread = _process->thread(tid);
+    if (thread == nullptr)
+      continue;
+
+    StopInfo const &stop = snapshotStopInfo(thread);
+    if (stop.reason == StopInfo::kReasonNone)
+      continue;
 
-  for (auto const &stop : stops) {
     threadsStopInfo.append(stop.encodeBriefJson());
   }
   return kSuccess;
@@ -112,6 +112,17 @@ ErrorCode DummySessionDelegateImpl::onQueryHostInfo(Session &,
   return kSuccess;
 }
 
+ErrorCode
+DummySessionDelegateImpl::onQueryResponseScope(Session &, ResponseScope scope,
+                                               std::string &key) const {
+  // Nothing about the host changes while we run.
+  if (scope != kResponseScopeHost)
+    return kErrorUnsupported;
+
+  key.clear();
+  return kSuccess;
+}
+
 DUMMY_IMPL_EMPTY(onQueryFileLoadAddress, Session &, std::string const &,
                  Address &)
 
@@ -121,6 +132,8 @@ DUMMY_IMPL_EMPTY(onNonStopMode, Session &, bool)
 
 DUMMY_IMPL_EMPTY(onEnableBTSTracing, Session &, bool)
 
+DUMMY_IMPL_EMPTY(onEnableDirtyPageTracking, Session &, bool)
+
 DUMMY_IMPL_EMPTY(onPassSignals, Session &, std::vector<int> const &)
 
 DUMMY_IMPL_EMPTY(onProgramSignals, Session &, std::vector<int> const &)
@@ -193,12 +206,22 @@ DUMMY_IMPL_EMPTY_CONST(onQueryProfileData, Session &, ProcessThreadId const &,
 DUMMY_IMPL_EMPTY(onResume, Session &, ThreadResumeAction::Collection const &,
                  StopInfo &)
 
+DUMMY_IMPL_EMPTY(onQueryStopEvent, Session &, StopInfo &)
+
+DUMMY_IMPL_EMPTY(onQueryOutput, Session &, std::string &)
+
 DUMMY_IMPL_EMPTY(onReadGeneralRegisters, Session &, ProcessThreadId const &,
                  Architecture::GPRegisterValueVector &)
 
 DUMMY_IMPL_EMPTY(onWriteGeneralRegisters, Session &, ProcessThreadId const &,
                  std::vector<uint64_t> const &)
 
+DUMMY_IMPL_EMPTY(onReadAllRegisters, Session &, ProcessThreadId const &,
+                 ByteVector &)
+
+DUMMY_IMPL_EMPTY(onWriteAllRegisters, Session &, ProcessThreadId const &,
+                 ByteVector const &)
+
 DUMMY_IMPL_EMPTY(onReadRegisterValue, Session &, ProcessThreadId const &,
                  uint32_t, std::string &)
 
@@ -213,6 +236,13 @@ DUMMY_IMPL_EMPTY(onRestoreRegisters, Session &, ProcessThreadId const &ptid,
 
 DUMMY_IMPL_EMPTY(onReadMemory, Session &, Address const &, size_t, ByteVector &)
 
+DUMMY_IMPL_EMPTY(onReadMemoryRanges, Session &,
+                 std::vector<std::pair<Address, size_t>> const &,
+                 std::vector<ByteVector> &)
+
+DUMMY_IMPL_EMPTY(onQueryDirtyPages, Session &, Address const &, size_t,
+                 size_t &, std::vector<bool> &)
+
 DUMMY_IMPL_EMPTY(onWriteMemory, Session &, Address const &, ByteVector const &,
                  size_t &)
 
@@ -228,8 +258,8 @@ DUMMY_IMPL_EMPTY(onComputeCRC, Session &, Address const &, size_t, uint32_t &)
 DUMMY_IMPL_EMPTY(onSearchBackward, Session &, Address const &, uint32_t,
                  uint32_t, Address &)
 
-DUMMY_IMPL_EMPTY(onSearch, Session &, Address const &, std::string const &,
-                 Address &)
+DUMMY_IMPL_EMPTY(onSearch, Session &, Address const &, size_t,
+                 std::string const &, Address &)
 
 DUMMY_IMPL_EMPTY(onInsertBreakpoint, Session &, BreakpointType, Address const &,
                  uint32_t, StringCollection const &, StringCollection const &,
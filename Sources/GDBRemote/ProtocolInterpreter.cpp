@@ -111,6 +111,18 @@ void ProtocolInterpreter::onPacketData(std::string const &data, bool valid) {
     } else {
       command_end = 1;
     }
+  } else if (data[0] == 'M') {
+    //
+    // Apart from 'M' itself, only 'MultiMemRead' is known; it is
+    // terminated with : (colon).
+    //
+    static std::string const multiMemRead = "MultiMemRead:";
+    if (data.compare(0, multiMemRead.length(), multiMemRead) == 0) {
+      command_end = multiMemRead.length() - 1;
+      args_start = multiMemRead.length();
+    } else {
+      command_end = 1;
+    }
   } else if (data[0] == 'j') {
     //
     // The commands starting with j are terminated with : (colon)
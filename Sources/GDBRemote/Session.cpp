@@ -18,9 +18,11 @@
 #include "DebugServer2/Utils/String.h"
 #include "DebugServer2/Utils/SwapEndian.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <iomanip>
+#include <mutex>
 #include <sstream>
 
 #if defined(OS_POSIX)
@@ -36,8 +38,18 @@
 namespace ds2 {
 namespace GDBRemote {
 
+// Size of the memory windows at PC and SP sent in stop replies, unless the
+// debugger asks for something else in qSupported; GDB ignores these blocks
+// so we only send them to LLDB by default.
+static size_t const kDefaultExpeditedMemorySize = 0x40;
+static size_t const kMaxExpeditedMemorySize = 0x400;
+
 Session::Session(CompatibilityMode mode)
-    : SessionBase(mode), _threadsInStopReply(false) {
+    : SessionBase(mode), _threadsInStopReply(false),
+      _expeditedMemorySize(
+          mode == kCompatibilityModeLLDB ? kDefaultExpeditedMemorySize : 0),
+      _expeditedRegisters(kExpediteAllRegisters), _binaryRegisters(false),
+      _nonStopMode(false) {
 #define REGISTER_HANDLER_EQUALS_2(MESSAGE, HANDLER)                            \
   interpreter().registerHandler(ProtocolInterpreter::Handler::kModeEquals,     \
                                 MESSAGE, this, &Session::Handle_##HANDLER);
@@ -75,10 +87,12 @@ Session::Session(CompatibilityMode mode)
   REGISTER_HANDLER_EQUALS_1(_m);
   REGISTER_HANDLER_EQUALS_1(M);
   REGISTER_HANDLER_EQUALS_1(m);
+  REGISTER_HANDLER_EQUALS_1(MultiMemRead);
   REGISTER_HANDLER_EQUALS_1(P);
   REGISTER_HANDLER_EQUALS_1(p);
   REGISTER_HANDLER_EQUALS_1(QAgent);
   REGISTER_HANDLER_EQUALS_1(QAllow);
+  REGISTER_HANDLER_EQUALS_1(QDirtyPageTracking);
   REGISTER_HANDLER_EQUALS_1(QDisableRandomization);
   REGISTER_HANDLER_EQUALS_1(QEnvironment);
   REGISTER_HANDLER_EQUALS_1(QEnvironmentHexEncoded);
@@ -105,6 +119,7 @@ Session::Session(CompatibilityMode mode)
   REGISTER_HANDLER_EQUALS_1(qAttached);
   REGISTER_HANDLER_EQUALS_1(qC);
   REGISTER_HANDLER_EQUALS_1(qCRC);
+  REGISTER_HANDLER_EQUALS_1(qDirtyPages);
   REGISTER_HANDLER_EQUALS_1(qFileLoadAddress);
   REGISTER_HANDLER_EQUALS_1(qGDBServerVersion);
   REGISTER_HANDLER_EQUALS_1(qGetPid);
@@ -119,6 +134,7 @@ Session::Session(CompatibilityMode mode)
   REGISTER_HANDLER_EQUALS_1(qLaunchGDBServer);
   REGISTER_HANDLER_EQUALS_1(qLaunchSuccess);
   REGISTER_HANDLER_EQUALS_1(qMemoryRegionInfo);
+  REGISTER_HANDLER_EQUALS_1(qMemoryRegions);
   REGISTER_HANDLER_EQUALS_1(qModuleInfo);
   REGISTER_HANDLER_EQUALS_1(qOffsets);
   REGISTER_HANDLER_EQUALS_1(qP);
@@ -165,6 +181,7 @@ Session::Session(CompatibilityMode mode)
   REGISTER_HANDLER_EQUALS_1(vFlashWrite);
   REGISTER_HANDLER_EQUALS_1(vKill);
   REGISTER_HANDLER_EQUALS_1(vRun);
+  REGISTER_HANDLER_EQUALS_1(vStdio);
   REGISTER_HANDLER_EQUALS_1(vStopped);
   REGISTER_HANDLER_EQUALS_1(X);
   REGISTER_HANDLER_EQUALS_1(x);
@@ -177,6 +194,73 @@ Session::Session(CompatibilityMode mode)
 #undef REGISTER_HANDLER_EQUALS_2
 }
 
+Session::~Session() {
+  // The delegate stops waking us up when leaving non-stop mode.
+  if (_nonStopMode && _delegate != nullptr) {
+    _delegate->onNonStopMode(*this, false);
+  }
+}
+
+//
+// Responses to static queries (host and process information, register
+// layout, target description) are kept for the lifetime of the server and
+// shared by all its sessions, so a debugger reconnecting, or connecting to
+// a new inferior of the same architecture, gets them without rebuilding
+// them. Each scope remembers the key the delegate gave for the responses it
+// holds, and drops them once the key changes (e.g. the inferior exec'd).
+//
+namespace {
+struct ResponseCache {
+  std::string key;
+  std::map<std::string, std::string> responses;
+};
+
+std::mutex gResponseCacheLock;
+ResponseCache gResponseCache[kResponseScopeCount];
+}
+
+void Session::sendCachedResponse(
+    ResponseScope scope, std::string const &packet,
+    std::function<ErrorCode(std::string &)> const &generate) {
+  std::string key;
+  bool cacheable =
+      _delegate->onQueryResponseScope(*this, scope, key) == kSuccess;
+
+  // The same packet may get different answers in GDB and LLDB modes.
+  std::string request = std::to_string(_compatMode) + ':' + packet;
+  std::string response;
+  bool cached = false;
+
+  if (cacheable) {
+    std::lock_guard<std::mutex> guard(gResponseCacheLock);
+    ResponseCache &cache = gResponseCache[scope];
+    if (cache.key != key) {
+      cache.key = key;
+      cache.responses.clear();
+    }
+
+    auto it = cache.responses.find(request);
+    if (it != cache.responses.end()) {
+      response = it->second;
+      cached = true;
+    }
+  }
+
+  if (!cached) {
+    CHK_SEND(generate(response));
+
+    if (cacheable) {
+      std::lock_guard<std::mutex> guard(gResponseCacheLock);
+      ResponseCache &cache = gResponseCache[scope];
+      if (cache.key == key) {
+        cache.responses[request] = response;
+      }
+    }
+  }
+
+  send(response);
+}
+
 bool Session::ParseList(std::string const &string, char separator,
                         std::function<void(std::string const &)> const &cb) {
   if (string.empty())
@@ -322,6 +406,34 @@ void Session::Handle_ExclamationMark(ProtocolInterpreter::Handler const &,
 //
 void Session::Handle_QuestionMark(ProtocolInterpreter::Handler const &,
                                   std::string const &) {
+  if (_nonStopMode) {
+    //
+    // Report all the stopped threads, the debugger gets them one at a time
+    // with vStopped.
+    //
+    _pendingStops.clear();
+
+    ThreadId tid;
+    ErrorCode error =
+        _delegate->onQueryThreadList(*this, kAnyProcessId, kAllThreadId, tid);
+    while (error == kSuccess) {
+      StopInfo stop;
+      if (_delegate->onQueryThreadStopInfo(
+              *this, ProcessThreadId(kAnyProcessId, tid), stop) == kSuccess) {
+        _pendingStops.push_back(stop);
+      }
+      error =
+          _delegate->onQueryThreadList(*this, kAnyProcessId, kAnyThreadId, tid);
+    }
+
+    if (_pendingStops.empty()) {
+      sendOK();
+    } else {
+      send(_pendingStops.front().encode(_compatMode, _threadsInStopReply));
+    }
+    return;
+  }
+
   StopInfo stop;
   CHK_SEND(_delegate->onQueryThreadStopInfo(*this, ProcessThreadId(), stop));
 
@@ -447,14 +559,7 @@ void Session::Handle_bc(ProtocolInterpreter::Handler const &,
   StopInfo stop;
   CHK_SEND(_delegate->onResume(*this, actions, stop));
 
-  send(stop.encode(_compatMode, _threadsInStopReply));
-
-  if (_compatMode != kCompatibilityModeLLDB) {
-    //
-    // Update the 'c' and 'g' ptids.
-    //
-    _ptids['c'] = _ptids['g'] = stop.ptid;
-  }
+  sendResumeReply(stop);
 }
 
 //
@@ -473,14 +578,7 @@ void Session::Handle_bs(ProtocolInterpreter::Handler const &,
   StopInfo stop;
   CHK_SEND(_delegate->onResume(*this, actions, stop));
 
-  send(stop.encode(_compatMode, _threadsInStopReply));
-
-  if (_compatMode != kCompatibilityModeLLDB) {
-    //
-    // Update the 'c' and 'g' ptids.
-    //
-    _ptids['c'] = _ptids['g'] = stop.ptid;
-  }
+  sendResumeReply(stop);
 }
 
 //
@@ -533,14 +631,7 @@ void Session::Handle_C(ProtocolInterpreter::Handler const &,
   StopInfo stop;
   CHK_SEND(_delegate->onResume(*this, actions, stop));
 
-  send(stop.encode(_compatMode, _threadsInStopReply));
-
-  if (_compatMode != kCompatibilityModeLLDB) {
-    //
-    // Update the 'c' and 'g' ptids.
-    //
-    _ptids['c'] = _ptids['g'] = stop.ptid;
-  }
+  sendResumeReply(stop);
 }
 
 //
@@ -585,14 +676,7 @@ void Session::Handle_c(ProtocolInterpreter::Handler const &,
   StopInfo stop;
   CHK_SEND(_delegate->onResume(*this, actions, stop));
 
-  send(stop.encode(_compatMode, _threadsInStopReply));
-
-  if (_compatMode != kCompatibilityModeLLDB) {
-    //
-    // Update the 'c' and 'g' ptids.
-    //
-    _ptids['c'] = _ptids['g'] = stop.ptid;
-  }
+  sendResumeReply(stop);
 }
 
 //
@@ -628,26 +712,43 @@ void Session::Handle_d(ProtocolInterpreter::Handler const &,
 }
 
 //
-// Packet:        G[;thread:tid]
+// Packet:        G XX...[;thread:tid]
 // Description:   Write general registers
 // Compatibility: GDB, LLDB
 //
 void Session::Handle_G(ProtocolInterpreter::Handler const &,
                        std::string const &args) {
   ProcessThreadId ptid;
+  std::string data = args;
 
   if (_compatMode == kCompatibilityModeLLDB) {
     //
-    // LLDB will send ;thread:tid when sending this command; pid
+    // LLDB will send ;thread:tid after the register data; pid
     // is deduced from current process.
     //
-    if (!args.empty()) {
-      if (args[0] == ';') {
-        if (!ptid.parse(args.substr(1), kCompatibilityModeLLDBThread)) {
-          sendError(kErrorInvalidArgument);
-          return;
-        }
+    size_t pos = data.rfind(";thread:");
+    if (pos != std::string::npos) {
+      if (!ptid.parse(data.substr(pos + 1), kCompatibilityModeLLDBThread)) {
+        sendError(kErrorInvalidArgument);
+        return;
       }
+      data.erase(pos);
+    }
+
+    //
+    // LLDB writes the whole register context, laid out as described by
+    // qRegisterInfo; it is binary if both sides agreed on BinaryRegisters.
+    //
+    ByteVector context = _binaryRegisters
+                             ? ByteVector(data.begin(), data.end())
+                             : HexToByteVector(data);
+    ErrorCode error = _delegate->onWriteAllRegisters(*this, ptid, context);
+    //
+    // The general registers fallback below only understands hex data.
+    //
+    if (error != kErrorUnsupported || _binaryRegisters) {
+      sendError(error);
+      return;
     }
   } else {
     //
@@ -659,11 +760,11 @@ void Session::Handle_G(ProtocolInterpreter::Handler const &,
   std::vector<uint64_t> regs;
   size_t regsize = _delegate->getGPRSize() / 8; // Register size in bytes.
   size_t reglen = regsize * 2; // Two characters per byte in hex.
-  size_t nargs = args.size() / reglen;
+  size_t nargs = data.size() / reglen;
 
   for (size_t n = 0; n < nargs; n++) {
     Address address;
-    std::string val = args.substr(n * reglen, reglen);
+    std::string val = data.substr(n * reglen, reglen);
     char *eptr;
 
     parseAddress(address, val.c_str(), &eptr, kEndianNative);
@@ -696,6 +797,24 @@ void Session::Handle_g(ProtocolInterpreter::Handler const &,
         }
       }
     }
+
+    //
+    // Send the whole register context so that LLDB doesn't have to fetch
+    // floating point and vector registers one by one.
+    //
+    ByteVector context;
+    ErrorCode error = _delegate->onReadAllRegisters(*this, ptid, context);
+    if (error == kSuccess) {
+      if (_binaryRegisters) {
+        send(context);
+      } else {
+        send(ToHex(context));
+      }
+      return;
+    } else if (error != kErrorUnsupported || _binaryRegisters) {
+      sendError(error);
+      return;
+    }
   } else {
     //
     // Use what previously has been set with H packet.
@@ -803,12 +922,7 @@ void Session::Handle_I(ProtocolInterpreter::Handler const &,
     StopInfo stop;
     CHK_SEND(_delegate->onResume(*this, actions, stop));
 
-    send(stop.encode(_compatMode, _threadsInStopReply));
-
-    //
-    // Update the 'c' and 'g' ptids.
-    //
-    _ptids['c'] = _ptids['g'] = stop.ptid;
+    sendResumeReply(stop);
   }
 }
 
@@ -843,14 +957,7 @@ void Session::Handle_i(ProtocolInterpreter::Handler const &,
   StopInfo stop;
   CHK_SEND(_delegate->onResume(*this, actions, stop));
 
-  send(stop.encode(_compatMode, _threadsInStopReply));
-
-  if (_compatMode != kCompatibilityModeLLDB) {
-    //
-    // Update the 'c' and 'g' ptids.
-    //
-    _ptids['c'] = _ptids['g'] = stop.ptid;
-  }
+  sendResumeReply(stop);
 }
 
 //
@@ -1007,6 +1114,75 @@ void Session::Handle_m(ProtocolInterpreter::Handler const &,
   send(ToHex(data));
 }
 
+//
+// Packet:        MultiMemRead:ranges:addr1,length1[,addrN,lengthN...];
+// Description:   Read several ranges of target memory in one request. The
+//                reply lists the number of bytes read for each range (0 if
+//                the range couldn't be read at all) followed by the binary
+//                data of all ranges. Requests whose reply wouldn't fit in a
+//                packet are rejected.
+// Compatibility: LLDB
+//
+void Session::Handle_MultiMemRead(ProtocolInterpreter::Handler const &,
+                                  std::string const &args) {
+  // Room a range takes in the reply on top of its data, at most: its length
+  // in hex and a separator.
+  static size_t const kMaxRangeHeaderLength = sizeof(uint64_t) * 2 + 1;
+
+  if (args.compare(0, 7, "ranges:") != 0) {
+    sendError(kErrorInvalidArgument);
+    return;
+  }
+
+  std::vector<std::pair<Address, size_t>> ranges;
+  size_t replySize = 0;
+  char const *ptr = &args[7];
+  while (*ptr != ';' && *ptr != '\0') {
+    char *eptr;
+    uint64_t address = strtoull(ptr, &eptr, 16);
+    if (*eptr++ != ',') {
+      sendError(kErrorInvalidArgument);
+      return;
+    }
+    uint64_t length = strtoull(eptr, &eptr, 16);
+    if (*eptr == ',') {
+      eptr++;
+    } else if (*eptr != ';' && *eptr != '\0') {
+      sendError(kErrorInvalidArgument);
+      return;
+    }
+    if (length > kMaxPacketSize ||
+        replySize + length + kMaxRangeHeaderLength > kMaxPacketSize) {
+      sendError(kErrorInvalidArgument);
+      return;
+    }
+    replySize += length + kMaxRangeHeaderLength;
+    ranges.emplace_back(address, length);
+    ptr = eptr;
+  }
+
+  if (ranges.empty()) {
+    sendError(kErrorInvalidArgument);
+    return;
+  }
+
+  std::vector<ByteVector> data;
+  CHK_SEND(_delegate->onReadMemoryRanges(*this, ranges, data));
+
+  std::ostringstream ss;
+  for (size_t n = 0; n < data.size(); n++) {
+    if (n != 0) {
+      ss << ',';
+    }
+    ss << std::hex << data[n].size();
+  }
+  ss << ';';
+  for (auto const &block : data) {
+    ss.write(reinterpret_cast<char const *>(block.data()), block.size());
+  }
+  send(ss.str());
+}
+
 //
 // Packet:        P n=r
 // Description:   Write register n value r
@@ -1133,7 +1309,75 @@ void Session::Handle_QEnvironmentHexEncoded(
 //
 void Session::Handle_QNonStop(ProtocolInterpreter::Handler const &,
                               std::string const &args) {
-  sendError(_delegate->onNonStopMode(*this, std::atoi(args.c_str()) != 0));
+  bool enable = std::atoi(args.c_str()) != 0;
+
+  ErrorCode error = _delegate->onNonStopMode(*this, enable);
+  if (error == kSuccess) {
+    _nonStopMode = enable;
+    _pendingStops.clear();
+    _pendingOutput.clear();
+  }
+
+  sendError(error);
+}
+
+//
+// Reply to a packet that resumed the process. In non-stop mode, the resume
+// is only acknowledged, the stops are notified later on.
+//
+void Session::sendResumeReply(StopInfo const &stop) {
+  if (_nonStopMode) {
+    sendOK();
+    return;
+  }
+
+  send(stop.encode(_compatMode, _threadsInStopReply));
+
+  if (_compatMode != kCompatibilityModeLLDB) {
+    //
+    // Update the 'c' and 'g' ptids.
+    //
+    _ptids['c'] = _ptids['g'] = stop.ptid;
+  }
+}
+
+//
+// In non-stop mode, threads stop while we wait for packets; the delegate
+// wakes us up when they do. The debugger is told about the first stop with a
+// %Stop notification and gets the others with vStopped; no other
+// notification is sent until it has seen them all. Inferior output is queued
+// the same way, as %Stdio notifications drained with vStdio, since O packets
+// are only allowed in reply to a resume.
+//
+void Session::onIdle() {
+  if (!_nonStopMode)
+    return;
+
+  bool notifyStop = _pendingStops.empty();
+  bool notifyOutput = _pendingOutput.empty();
+
+  for (;;) {
+    StopInfo stop;
+    if (_delegate->onQueryStopEvent(*this, stop) != kSuccess)
+      break;
+    _pendingStops.push_back(stop);
+  }
+
+  for (;;) {
+    std::string output;
+    if (_delegate->onQueryOutput(*this, output) != kSuccess)
+      break;
+    _pendingOutput.push_back(output);
+  }
+
+  if (notifyStop && !_pendingStops.empty()) {
+    sendNotification("Stop", _pendingStops.front().encode(
+                                 _compatMode, _threadsInStopReply));
+  }
+
+  if (notifyOutput && !_pendingOutput.empty()) {
+    sendNotification("Stdio", "O" + ToHex(_pendingOutput.front()));
+  }
 }
 
 //
@@ -1285,6 +1529,19 @@ void Session::Handle_Qbtrace(ProtocolInterpreter::Handler const &,
   sendError(_delegate->onEnableBTSTracing(*this, enabled));
 }
 
+//
+// Packet:        QDirtyPageTracking:value
+// Description:   Turns on or off the tracking of the pages written by the
+//                inferior between a resume and the following stop, which
+//                can then be queried with qDirtyPages.
+// Compatibility: LLDB
+//
+void Session::Handle_QDirtyPageTracking(ProtocolInterpreter::Handler const &,
+                                        std::string const &args) {
+  uint32_t value = std::strtoul(args.c_str(), nullptr, 16);
+  sendError(_delegate->onEnableDirtyPageTracking(*this, value != 0));
+}
+
 //
 // Packet:        QDisableRandomization:value
 // Description:   Disable Address Space Layout Randomization
@@ -1516,7 +1773,7 @@ void Session::Handle_qC(ProtocolInterpreter::Handler const &,
 
 //
 // Packet:        qCRC addr,length
-// Description:   Compute CRC of the target memory
+// Description:   Compute CRC of the target memory, replied as Ccrc32
 // Compatibility: GDB
 //
 void Session::Handle_qCRC(ProtocolInterpreter::Handler const &,
@@ -1537,7 +1794,56 @@ void Session::Handle_qCRC(ProtocolInterpreter::Handler const &,
   CHK_SEND(_delegate->onComputeCRC(*this, address, length, crc));
 
   std::ostringstream ss;
-  ss << std::hex << std::setw(8) << std::setfill('0') << crc;
+  ss << 'C' << std::hex << std::setw(8) << std::setfill('0') << crc;
+  send(ss.str());
+}
+
+//
+// Packet:        qDirtyPages:addr,length
+// Description:   Returns which pages of the range were written by the
+//                inferior since it was last resumed, as the page size
+//                followed by a bitmap: bit N of byte M is set if page
+//                8 * M + N, counting from the page containing addr, is
+//                dirty. Long ranges are truncated; the debugger asks again
+//                for the pages that are not covered by the bitmap.
+// Compatibility: LLDB
+//
+void Session::Handle_qDirtyPages(ProtocolInterpreter::Handler const &,
+                                 std::string const &args) {
+  // Keeps the hex encoded bitmap within our advertised packet size.
+  static size_t const kMaxDirtyPagesBitmapSize = 0x1000;
+
+  char *eptr;
+  uint64_t address = strtoull(args.c_str(), &eptr, 16);
+  if (*eptr++ != ',') {
+    sendError(kErrorInvalidArgument);
+    return;
+  }
+  uint64_t length = strtoull(eptr, nullptr, 16);
+  if (length == 0) {
+    sendError(kErrorInvalidArgument);
+    return;
+  }
+
+  // Don't make the inferior side look at more pages than we can report,
+  // assuming the smallest page size.
+  length = std::min<uint64_t>(length, kMaxDirtyPagesBitmapSize * 8 * 0x1000);
+
+  size_t pageSize = 0;
+  std::vector<bool> dirty;
+  CHK_SEND(_delegate->onQueryDirtyPages(*this, address, length, pageSize,
+                                        dirty));
+
+  ByteVector bitmap(
+      std::min((dirty.size() + 7) / 8, kMaxDirtyPagesBitmapSize), 0);
+  for (size_t n = 0; n < dirty.size() && n / 8 < bitmap.size(); n++) {
+    if (dirty[n]) {
+      bitmap[n / 8] |= 1 << (n % 8);
+    }
+  }
+
+  std::ostringstream ss;
+  ss << std::hex << pageSize << ';' << ToHex(bitmap);
   send(ss.str());
 }
 
@@ -1695,10 +2001,13 @@ void Session::Handle_qGroupName(ProtocolInterpreter::Handler const &,
 //
 void Session::Handle_qHostInfo(ProtocolInterpreter::Handler const &,
                                std::string const &) {
-  HostInfo info;
-  CHK_SEND(_delegate->onQueryHostInfo(*this, info));
-
-  send(info.encode());
+  sendCachedResponse(kResponseScopeHost, "qHostInfo",
+                     [this](std::string &response) -> ErrorCode {
+                       HostInfo info;
+                       CHK(_delegate->onQueryHostInfo(*this, info));
+                       response = info.encode();
+                       return kSuccess;
+                     });
 }
 
 //
@@ -1824,6 +2133,67 @@ void Session::Handle_qMemoryRegionInfo(ProtocolInterpreter::Handler const &,
   send(info.encode());
 }
 
+//
+// Packet:        qMemoryRegions:addr
+// Description:   Returns information about the memory regions starting
+//                with the one containing addr, as many as fit in a packet.
+//                Each region is encoded like a qMemoryRegionInfo reply and
+//                regions are separated by '|'. The reply starts with 'm' if
+//                the debugger should ask again from the end of the last
+//                region or with 'l' if it reaches the end of the address
+//                space. A region that doesn't fit in a packet by itself is
+//                an error, the debugger can still use qMemoryRegionInfo.
+// Compatibility: LLDB
+//
+void Session::Handle_qMemoryRegions(ProtocolInterpreter::Handler const &,
+                                    std::string const &args) {
+  uint64_t address = strtoull(args.c_str(), nullptr, 16);
+  std::string regions;
+  bool last = false;
+
+  for (;;) {
+    MemoryRegionInfo info;
+    ErrorCode error = _delegate->onQueryMemoryRegionInfo(*this, address, info);
+    if (error != kSuccess) {
+      if (regions.empty()) {
+        sendError(error);
+        return;
+      }
+      break;
+    }
+
+    // Past the end of the address space we get the last region again.
+    if (!regions.empty() && info.start.value() != address) {
+      last = true;
+      break;
+    }
+
+    // The reply starts with 'm' or 'l', regions are separated by '|'.
+    std::string region = info.encode();
+    if (1 + regions.length() + 1 + region.length() > kMaxPacketSize) {
+      if (regions.empty()) {
+        sendError(kErrorInvalidArgument);
+        return;
+      }
+      break;
+    }
+
+    if (!regions.empty()) {
+      regions += '|';
+    }
+    regions += region;
+
+    uint64_t end = info.start.value() + info.length;
+    if (info.length == 0 || end <= address) {
+      last = true;
+      break;
+    }
+    address = end;
+  }
+
+  send((last ? "l" : "m") + regions);
+}
+
 //
 // Packet:        qModuleInfo:<module_path>;<arch triple>
 // Description:   Get information for a module by given module path and
@@ -1992,10 +2362,13 @@ void Session::Handle_qPlatform_shell(ProtocolInterpreter::Handler const &,
 //
 void Session::Handle_qProcessInfo(ProtocolInterpreter::Handler const &,
                                   std::string const &) {
-  ProcessInfo info;
-  CHK_SEND(_delegate->onQueryProcessInfo(*this, info));
-
-  send(info.encode(_compatMode));
+  sendCachedResponse(kResponseScopeProcess, "qProcessInfo",
+                     [this](std::string &response) -> ErrorCode {
+                       ProcessInfo info;
+                       CHK(_delegate->onQueryProcessInfo(*this, info));
+                       response = info.encode(_compatMode);
+                       return kSuccess;
+                     });
 }
 
 //
@@ -2043,10 +2416,13 @@ void Session::Handle_qRegisterInfo(ProtocolInterpreter::Handler const &,
                                    std::string const &args) {
   uint32_t regno = std::strtoul(args.c_str(), nullptr, 16);
 
-  RegisterInfo info;
-  CHK_SEND(_delegate->onQueryRegisterInfo(*this, regno, info));
-
-  send(info.encode());
+  sendCachedResponse(kResponseScopeRegisters, "qRegisterInfo" + args,
+                     [this, regno](std::string &response) -> ErrorCode {
+                       RegisterInfo info;
+                       CHK(_delegate->onQueryRegisterInfo(*this, regno, info));
+                       response = info.encode();
+                       return kSuccess;
+                     });
 }
 
 //
@@ -2073,9 +2449,12 @@ void Session::Handle_qSearch(ProtocolInterpreter::Handler const &,
     return;
   }
 
+  // The pattern is binary data and may contain NUL bytes.
+  std::string pattern = args.substr(eptr - &args[0]);
+
   Address location;
-  ErrorCode error = _delegate->onSearch(
-      *this, address, std::string(HexToString(eptr), length), location);
+  ErrorCode error =
+      _delegate->onSearch(*this, address, length, pattern, location);
   if (error != kSuccess && error != kErrorNotFound) {
     sendError(error);
     return;
@@ -2085,7 +2464,7 @@ void Session::Handle_qSearch(ProtocolInterpreter::Handler const &,
   if (error == kErrorNotFound) {
     ss << '0';
   } else {
-    ss << '1' << ',' << formatAddress(address, kEndianBig);
+    ss << '1' << ',' << formatAddress(location, kEndianBig);
   }
   send(ss.str());
 }
@@ -2160,6 +2539,39 @@ void Session::Handle_qSupported(ProtocolInterpreter::Handler const &,
     if (feature.name == "multiprocess" && feature.flag == Feature::kSupported) {
       DS2LOG(Debug, "entering GDB multiprocess compatibility mode");
       _compatMode = kCompatibilityModeGDBMultiprocess;
+    } else if (feature.name == "ExpeditedMemory") {
+      if (!feature.value.empty()) {
+        _expeditedMemorySize =
+            std::min<size_t>(std::strtoull(feature.value.c_str(), nullptr, 16),
+                             kMaxExpeditedMemorySize);
+      } else {
+        _expeditedMemorySize = (feature.flag == Feature::kSupported)
+                                   ? kDefaultExpeditedMemorySize
+                                   : 0;
+      }
+    } else if (feature.name == "ExpeditedRegisters") {
+      //
+      // ExpeditedRegisters=all, ExpeditedRegisters=generic or a list of
+      // register numbers, e.g. ExpeditedRegisters=7,10; "-" is the same as
+      // "generic".
+      //
+      _expeditedRegisterList.clear();
+      if (feature.value.empty() || feature.value == "all") {
+        _expeditedRegisters = (feature.flag == Feature::kNotSupported)
+                                  ? kExpediteGenericRegisters
+                                  : kExpediteAllRegisters;
+      } else if (feature.value == "generic") {
+        _expeditedRegisters = kExpediteGenericRegisters;
+      } else {
+        _expeditedRegisters = kExpediteListedRegisters;
+        ParseList(feature.value, ',', [&](std::string const &regno) {
+          _expeditedRegisterList.insert(
+              std::strtoul(regno.c_str(), nullptr, 16));
+        });
+      }
+    } else if (feature.name == "BinaryRegisters") {
+      _binaryRegisters = (_compatMode == kCompatibilityModeLLDB &&
+                          feature.flag == Feature::kSupported);
     }
   });
 
@@ -2271,6 +2683,12 @@ void Session::Handle_qThreadStopInfo(ProtocolInterpreter::Handler const &,
     _ptids['c'] = _ptids['g'] = stop.ptid;
   }
 
+  // The delegate may have collected the state of all threads already.
+  if (!stop.threadStops.empty()) {
+    send(stop.encode(_compatMode, true));
+    return;
+  }
+
   JSArray threadsStopInfo;
   CHK_SEND(_delegate->createThreadsStopInfo(*this, threadsStopInfo));
 
@@ -2428,13 +2846,25 @@ void Session::Handle_qXfer(ProtocolInterpreter::Handler const &,
     uint64_t length =
         strtoull(args.substr(length_start, length_end - length_start).c_str(),
                  nullptr, 16);
-    bool last = true;
-    std::string buffer;
+    auto generate = [&](std::string &response) -> ErrorCode {
+      bool last = true;
+      std::string buffer;
+
+      CHK(_delegate->onXferRead(*this, object, annex, offset, length, buffer,
+                                last));
 
-    CHK_SEND(_delegate->onXferRead(*this, object, annex, offset, length, buffer,
-                                   last));
+      response = (last || buffer.empty() ? "l" : "m") + buffer;
+      return kSuccess;
+    };
 
-    send((last || buffer.empty() ? "l" : "m") + buffer);
+    // Target descriptions only depend on the register layout.
+    if (object == "features") {
+      sendCachedResponse(kResponseScopeRegisters, "qXfer:" + args, generate);
+    } else {
+      std::string response;
+      CHK_SEND(generate(response));
+      send(response);
+    }
   } else {
     sendError(kErrorInvalidArgument);
   }
@@ -2513,21 +2943,7 @@ void Session::Handle_qsProcessInfo(ProtocolInterpreter::Handler const &,
 //
 void Session::Handle_qfThreadInfo(ProtocolInterpreter::Handler const &,
                                   std::string const &) {
-  ThreadId tid;
-  ErrorCode error =
-      _delegate->onQueryThreadList(*this, kAnyProcessId, kAllThreadId, tid);
-  if (error != kSuccess && error != kErrorNotFound) {
-    sendError(error);
-    return;
-  }
-
-  if (error == kErrorNotFound) {
-    send("l");
-  } else {
-    std::ostringstream ss;
-    ss << "m" << getPacketSeparator() << std::hex << tid;
-    send(ss.str());
-  }
+  sendThreadList(kAllThreadId);
 }
 
 //
@@ -2537,19 +2953,43 @@ void Session::Handle_qfThreadInfo(ProtocolInterpreter::Handler const &,
 //
 void Session::Handle_qsThreadInfo(ProtocolInterpreter::Handler const &,
                                   std::string const &) {
-  ThreadId tid;
-  ErrorCode error =
-      _delegate->onQueryThreadList(*this, kAnyProcessId, kAnyThreadId, tid);
-  if (error != kSuccess && error != kErrorNotFound) {
-    sendError(error);
-    return;
+  sendThreadList(kAnyThreadId);
+}
+
+//
+// Pack as many thread ids as fit in a packet in a single m reply; the
+// delegate resumes where we stopped on the next qsThreadInfo.
+//
+void Session::sendThreadList(ThreadId lastTid) {
+  // A thread id never takes more hex digits than this, check for room
+  // before asking for the next one so that no id gets dropped.
+  static size_t const kMaxThreadIdLength = sizeof(ThreadId) * 2 + 1;
+
+  std::ostringstream ss;
+  size_t count = 0;
+
+  ss << "m" << getPacketSeparator() << std::hex;
+  while (static_cast<size_t>(ss.tellp()) + kMaxThreadIdLength <=
+         kMaxPacketSize) {
+    ThreadId tid;
+    ErrorCode error =
+        _delegate->onQueryThreadList(*this, kAnyProcessId, lastTid, tid);
+    if (error == kErrorNotFound)
+      break;
+    if (error != kSuccess) {
+      sendError(error);
+      return;
+    }
+
+    if (count++ > 0)
+      ss << ',';
+    ss << tid;
+    lastTid = kAnyThreadId;
   }
 
-  if (error == kErrorNotFound) {
+  if (count == 0) {
     send("l");
   } else {
-    std::ostringstream ss;
-    ss << "m" << getPacketSeparator() << std::hex << tid;
     send(ss.str());
   }
 }
@@ -2624,14 +3064,7 @@ void Session::Handle_S(ProtocolInterpreter::Handler const &,
   StopInfo stop;
   CHK_SEND(_delegate->onResume(*this, actions, stop));
 
-  send(stop.encode(_compatMode, _threadsInStopReply));
-
-  if (_compatMode != kCompatibilityModeLLDB) {
-    //
-    // Update the 'c' and 'g' ptids.
-    //
-    _ptids['c'] = _ptids['g'] = stop.ptid;
-  }
+  sendResumeReply(stop);
 }
 
 //
@@ -2676,14 +3109,7 @@ void Session::Handle_s(ProtocolInterpreter::Handler const &,
   StopInfo stop;
   CHK_SEND(_delegate->onResume(*this, actions, stop));
 
-  send(stop.encode(_compatMode, _threadsInStopReply));
-
-  if (_compatMode != kCompatibilityModeLLDB) {
-    //
-    // Update the 'c' and 'g' ptids.
-    //
-    _ptids['c'] = _ptids['g'] = stop.ptid;
-  }
+  sendResumeReply(stop);
 }
 
 //
@@ -2880,14 +3306,7 @@ void Session::Handle_vCont(ProtocolInterpreter::Handler const &,
   StopInfo stop;
   CHK_SEND(_delegate->onResume(*this, actions, stop));
 
-  send(stop.encode(_compatMode, _threadsInStopReply));
-
-  if (_compatMode != kCompatibilityModeLLDB) {
-    //
-    // Update the 'c' and 'g' ptids.
-    //
-    _ptids['c'] = _ptids['g'] = stop.ptid;
-  }
+  sendResumeReply(stop);
 }
 
 //
@@ -3178,6 +3597,26 @@ void Session::Handle_vRun(ProtocolInterpreter::Handler const &,
   }
 }
 
+//
+// Packet:        vStdio
+// Description:   Reply the next inferior output in non-stop mode.
+// Compatibility: LLDB
+//
+void Session::Handle_vStdio(ProtocolInterpreter::Handler const &,
+                            std::string const &) {
+  // Same as vStopped, for the %Stdio notifications.
+  if (!_pendingOutput.empty()) {
+    _pendingOutput.pop_front();
+  }
+
+  if (_pendingOutput.empty()) {
+    sendOK();
+    return;
+  }
+
+  send("O" + ToHex(_pendingOutput.front()));
+}
+
 //
 // Packet:        vStopped
 // Description:   Reply the thread stop code.
@@ -3185,26 +3624,22 @@ void Session::Handle_vRun(ProtocolInterpreter::Handler const &,
 //
 void Session::Handle_vStopped(ProtocolInterpreter::Handler const &,
                               std::string const &) {
-  StopInfo stop;
-  ErrorCode error =
-      _delegate->onQueryThreadStopInfo(*this, ProcessThreadId(), stop);
-  if (error != kSuccess && error != kErrorNotFound) {
-    sendError(error);
-    return;
+  //
+  // The debugger is done with the stop at the head of the queue, which is
+  // the last one we sent it; reply with the next one.
+  //
+  if (!_pendingStops.empty()) {
+    _pendingStops.pop_front();
   }
 
-  if (error == kSuccess) {
-    send(stop.encode(_compatMode, _threadsInStopReply));
-
-    if (_compatMode != kCompatibilityModeLLDB) {
-      //
-      // Update the 'c' and 'g' ptids.
-      //
-      _ptids['c'] = _ptids['g'] = stop.ptid;
-    }
-  } else {
+  if (_pendingStops.empty()) {
     sendOK();
+    return;
   }
+
+  // Unlike stop replies, stops reported in non-stop mode don't change the
+  // threads selected with H behind the debugger's back.
+  send(_pendingStops.front().encode(_compatMode, _threadsInStopReply));
 }
 
 //
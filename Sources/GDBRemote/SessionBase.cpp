@@ -50,8 +50,10 @@ bool SessionBase::receive(bool cooked) {
   if (!_channel->receive(data))
     return false;
 
-  if (data.empty())
+  if (data.empty()) {
+    onIdle();
     return true;
+  }
 
   if (cooked) {
     //
@@ -14,7 +14,6 @@
 #include "DebugServer2/Utils/Log.h"
 #include "DebugServer2/Utils/String.h"
 #include "DebugServer2/Utils/Stringify.h"
-#include "DebugServer2/Utils/SwapEndian.h"
 #include "JSObjects/JSObjects.h"
 
 #include <cerrno>
@@ -278,46 +277,69 @@ std::string StopInfo::encodeInfo(CompatibilityMode mode,
         first = false;
       }
     }
+
+    // The debugger pairs these with the thread list by position, so only
+    // send them if we have one for each thread.
+    if (!threadPCs.empty() && threadPCs.size() == threads.size()) {
+      ss << ';' << "thread-pcs:";
+      bool first = true;
+      for (auto const &pc : threadPCs) {
+        if (!first) {
+          ss << ',';
+        }
+        ss << HEX0 << pc.second;
+        first = false;
+      }
+    }
   }
 
   return ss.str();
 }
 
-void StopInfo::encodeRegisters(std::map<std::string, std::string> &regs,
-                               bool hexIndex) const {
-  for (auto &reg : registers) {
-    std::stringstream regNum;
-    std::stringstream regVal;
-    size_t regsize = reg.second.size << 3;
-
-    if (hexIndex) {
-      regNum << HEX(2) << (reg.first & 0xff);
-    } else {
-      regNum << DEC << reg.first;
-    }
-
+// Register values are sent in target byte order.
+static void EncodeRegisterValue(std::string &out,
+                                Architecture::GPRegisterValue const &reg) {
+  for (size_t n = 0; n < reg.size; n++) {
 #if defined(ENDIAN_BIG)
-    regVal << HEX(regsize >> 2) << reg.second.value;
+    uint8_t byte = reg.value >> ((reg.size - n - 1) << 3);
 #else
-    regVal << HEX(regsize >> 2) << (Swap64(reg.second.value) >> (64 - regsize));
+    uint8_t byte = reg.value >> (n << 3);
 #endif
-
-    regs.insert(std::make_pair(regNum.str(), regVal.str()));
+    out += NibbleToHex(byte >> 4);
+    out += NibbleToHex(byte & 0xf);
   }
 }
 
 std::string StopInfo::encodeRegisters() const {
+  std::string result;
+  result.reserve(registers.size() * 20);
+
+  for (auto const &reg : registers) {
+    if (!result.empty()) {
+      result += ';';
+    }
+
+    uint8_t regno = reg.first & 0xff;
+    result += NibbleToHex(regno >> 4);
+    result += NibbleToHex(regno & 0xf);
+    result += ':';
+    EncodeRegisterValue(result, reg.second);
+  }
+
+  return result;
+}
+
+std::string StopInfo::encodeMemory() const {
   std::ostringstream ss;
   bool first = true;
-  std::map<std::string, std::string> regs;
-  encodeRegisters(regs, true);
 
-  for (auto &reg : regs) {
+  for (auto const &block : memory) {
     if (!first) {
       ss << ';';
     }
 
-    ss << reg.first << ':' << reg.second;
+    ss << "memory:0x" << HEX0 << block.first << DEC << '='
+       << ToHex(block.second);
 
     first = false;
   }
@@ -325,6 +347,18 @@ std::string StopInfo::encodeRegisters() const {
   return ss.str();
 }
 
+std::string StopInfo::encodeThreadsStopInfo() const {
+  JSArray threadsStopInfo;
+
+  for (auto const &it : threadStops) {
+    StopInfo stop(it.second);
+    stop.ptid.tid = it.first;
+    threadsStopInfo.append(stop.encodeBriefJson());
+  }
+
+  return ToHex(threadsStopInfo.toString());
+}
+
 std::string StopInfo::encode(CompatibilityMode mode, bool listThreads) const {
   // We shouldn't be trying to encode something that has no stop event.
   DS2ASSERT(event != kEventNone);
@@ -404,9 +438,21 @@ std::string StopInfo::encode(CompatibilityMode mode, bool listThreads) const {
   //
   if (event == kEventStop && mode != kCompatibilityModeGDB) {
     if (mode == kCompatibilityModeLLDB) {
-      ss << encodeInfo(mode, listThreads) << ';' << encodeRegisters();
+      ss << encodeInfo(mode, listThreads);
+      if (!registers.empty()) {
+        ss << ';' << encodeRegisters();
+      }
+      if (!memory.empty()) {
+        ss << ';' << encodeMemory();
+      }
+      if (listThreads && !threadStops.empty()) {
+        ss << ';' << "jstopinfo:" << encodeThreadsStopInfo();
+      }
     } else {
-      ss << encodeRegisters() << ';' << encodeInfo(mode, listThreads);
+      if (!registers.empty()) {
+        ss << encodeRegisters() << ';';
+      }
+      ss << encodeInfo(mode, listThreads);
     }
 
     ss << ';';
@@ -429,7 +475,7 @@ JSDictionary *StopInfo::encodeJson() const {
   if (!threadName.empty())
     threadObj->set("name", JSString::New(threadName));
 
-  if (core)
+  if (!(core < 0))
     threadObj->set("core", JSInteger::New(core));
 
   if (watchpointAddress) {
@@ -439,11 +485,10 @@ JSDictionary *StopInfo::encodeJson() const {
   }
 
   auto regSet = JSDictionary::New();
-  std::map<std::string, std::string> regs;
-  encodeRegisters(regs, false);
-
-  for (auto const &reg : regs) {
-    regSet->set(reg.first, JSString::New(reg.second));
+  for (auto const &reg : registers) {
+    std::string value;
+    EncodeRegisterValue(value, reg.second);
+    regSet->set(std::to_string(reg.first), JSString::New(value));
   }
 
   threadObj->set("registers", regSet);
@@ -462,6 +507,10 @@ JSDictionary *StopInfo::encodeBriefJson() const {
     threadObj->set(key, JSString::New(val));
   }
 
+  if (reason != kReasonNone) {
+    threadObj->set("signal", JSInteger::New(signal));
+  }
+
   return threadObj;
 }
 
@@ -783,6 +832,13 @@ std::string MemoryRegionInfo::encode() const {
       ss << 'x';
     ss << ';';
   }
+#if defined(OS_LINUX)
+  if (!backingFile.empty()) {
+    ss << "name:" << ToHex(backingFile) << ';';
+    ss << "offset:" << HEX(8) << backingFileOffset << DEC << ';';
+    ss << "inode:" << backingFileInode << ';';
+  }
+#endif
 
   return ss.str();
 }
@@ -36,6 +36,10 @@ bool QueueChannel::wait(int ms) {
   return true;
 }
 
+// An empty message doesn't carry a packet, the session takes it for a
+// wake-up.
+void QueueChannel::wake() { _queue.put(std::string()); }
+
 ssize_t QueueChannel::send(void const *buffer, size_t length) {
   // Forward to the remote
   if (!connected())
@@ -245,19 +245,48 @@ ssize_t Socket::send(void const *buffer, size_t length) {
   if (!connected())
     return -1;
 
-  ssize_t nsent =
-      ::send(_handle, reinterpret_cast<const char *>(buffer), length, 0);
-  if (nsent < 0) {
-    int err = SOCK_ERRNO;
-    if (err != SOCK_WOULDBLOCK) {
-      close();
-      _lastError = err;
+  // The socket is non-blocking, so large packets (jThreadsInfo with thousands
+  // of threads is several megabytes) don't fit in the send buffer at once;
+  // wait for the peer to drain it rather than dropping the rest.
+  char const *data = reinterpret_cast<char const *>(buffer);
+  size_t nsent = 0;
+  while (nsent < length) {
+    ssize_t n = ::send(_handle, data + nsent, length - nsent, 0);
+    if (n < 0) {
+      int err = SOCK_ERRNO;
+      if (err != SOCK_WOULDBLOCK) {
+        close();
+        _lastError = err;
+        return -1;
+      }
+      if (!waitWritable()) {
+        return nsent > 0 ? static_cast<ssize_t>(nsent) : -1;
+      }
+      continue;
     }
-    return -1;
+    nsent += n;
   }
   return nsent;
 }
 
+bool Socket::waitWritable() {
+#if defined(OS_WIN32)
+  fd_set fds;
+  FD_ZERO(&fds);
+  FD_SET(_handle, &fds);
+  return ::select(_handle + 1, nullptr, &fds, nullptr, nullptr) == 1;
+#else
+  struct pollfd pfd;
+  pfd.fd = _handle;
+  pfd.events = POLLOUT;
+  int nfds;
+  do {
+    nfds = poll(&pfd, 1, -1);
+  } while (nfds < 0 && errno == EINTR);
+  return (nfds == 1 && (pfd.revents & POLLOUT) != 0);
+#endif
+}
+
 ssize_t Socket::receive(void *buffer, size_t length) {
   if (!connected())
     return -1;
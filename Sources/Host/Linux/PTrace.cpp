@@ -12,17 +12,24 @@
 
 #include "DebugServer2/Host/Linux/PTrace.h"
 #include "DebugServer2/Host/Linux/ExtraWrappers.h"
+#include "DebugServer2/Host/Linux/ProcFS.h"
 #include "DebugServer2/Host/Platform.h"
 #include "DebugServer2/Utils/Log.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <csignal>
 #include <cstddef>
 #include <cstdio>
+#include <cstring>
 #include <limits>
 #include <sys/uio.h>
 #include <sys/user.h>
 #include <sys/wait.h>
+#if defined(ARCH_X86) || defined(ARCH_X86_64)
+#include <cpuid.h>
+#include <elf.h>
+#endif
 
 #define super ds2::Host::POSIX::PTrace
 
@@ -30,6 +37,10 @@ namespace ds2 {
 namespace Host {
 namespace Linux {
 
+PTrace::PTrace() : _memoryPid(kAnyProcessId), _memoryFd(-1) {}
+
+PTrace::~PTrace() { closeMemoryFile(); }
+
 ErrorCode PTrace::wait(ProcessThreadId const &ptid, int *status) {
   pid_t pid;
 
@@ -51,6 +62,13 @@ ErrorCode PTrace::wait(ProcessThreadId const &ptid, int *status) {
   return kSuccess;
 }
 
+//
+// Trace clone and exit events to track threads, and exec events to know
+// when the process image changes.
+//
+static unsigned long const kTraceOptions =
+    PTRACE_O_TRACECLONE | PTRACE_O_TRACEEXEC;
+
 ErrorCode PTrace::traceMe(bool disableASLR) {
   if (disableASLR) {
     int persona = ::personality(std::numeric_limits<uint32_t>::max());
@@ -59,23 +77,113 @@ ErrorCode PTrace::traceMe(bool disableASLR) {
     }
   }
 
-  return super::traceMe(false);
+  //
+  // Instead of PTRACE_TRACEME, stop and let the debugger seize us (see
+  // traceChild); only seized tracees can be stopped with PTRACE_INTERRUPT.
+  //
+  if (::raise(SIGSTOP) != 0)
+    return Platform::TranslateError();
+
+  return kSuccess;
 }
 
 ErrorCode PTrace::traceThat(ProcessId pid) {
   if (pid <= 0)
     return kErrorInvalidArgument;
 
-  unsigned long traceFlags = PTRACE_O_TRACECLONE;
+  if (wrapPtrace(PTRACE_SETOPTIONS, pid, nullptr, kTraceOptions) < 0) {
+    DS2LOG(Warning, "unable to set trace options on pid %d, error=%s", pid,
+           strerror(errno));
+    return Platform::TranslateError();
+  }
+
+  return kSuccess;
+}
+
+ErrorCode PTrace::traceChild(ProcessId pid) {
+  if (pid <= 0)
+    return kErrorInvalidArgument;
+
+  // Wait for the child to stop itself in traceMe.
+  int status;
+  pid_t ret;
+  do {
+    ret = ::waitpid(pid, &status, WUNTRACED);
+  } while (ret < 0 && errno == EINTR);
+  if (ret != pid || !WIFSTOPPED(status))
+    return kErrorProcessNotFound;
+
+  if (wrapPtrace(PTRACE_SEIZE, pid, nullptr, kTraceOptions) < 0)
+    return Platform::TranslateError();
 
   //
-  // Trace clone and exit events to track threads.
+  // Wake the child up and let it run until its exec stop, which is left
+  // pending for the caller to wait for. Stops before that (the group-stop
+  // we just ended and the SIGCONT delivery) are ours to swallow.
   //
-  if (wrapPtrace(PTRACE_SETOPTIONS, pid, nullptr, traceFlags) < 0) {
-    DS2LOG(Warning, "unable to set PTRACE_O_TRACECLONE on pid %d, error=%s",
-           pid, strerror(errno));
+  if (::kill(pid, SIGCONT) < 0)
     return Platform::TranslateError();
+
+  for (;;) {
+    siginfo_t si;
+    if (::waitid(P_PID, pid, &si, WSTOPPED | WEXITED | WNOWAIT) < 0) {
+      if (errno == EINTR)
+        continue;
+      return Platform::TranslateError();
+    }
+
+    if (si.si_code != CLD_TRAPPED && si.si_code != CLD_STOPPED)
+      return kErrorProcessNotFound;
+
+    if (si.si_status == (SIGTRAP | (PTRACE_EVENT_EXEC << 8)))
+      return kSuccess;
+
+    CHK(wait(pid));
+    if (wrapPtrace(PTRACE_CONT, pid, nullptr, nullptr) < 0)
+      return Platform::TranslateError();
   }
+}
+
+ErrorCode PTrace::attach(ProcessId pid) {
+  if (pid <= kAnyProcessId)
+    return kErrorProcessNotFound;
+
+  DS2LOG(Debug, "seizing pid %" PRIu64, (uint64_t)pid);
+
+  //
+  // Seize the thread rather than attaching to it so that it can later be
+  // stopped with PTRACE_INTERRUPT, and interrupt it to get the initial stop
+  // PTRACE_ATTACH would have caused.
+  //
+  if (wrapPtrace(PTRACE_SEIZE, pid, nullptr, kTraceOptions) < 0)
+    return Platform::TranslateError();
+
+  if (wrapPtrace(PTRACE_INTERRUPT, pid, nullptr, nullptr) < 0)
+    return Platform::TranslateError();
+
+  return kSuccess;
+}
+
+ErrorCode PTrace::suspend(ProcessThreadId const &ptid) {
+  pid_t pid;
+  CHK(ptidToPid(ptid, pid));
+
+  //
+  // Unlike a SIGSTOP, an interrupt leaves no signal behind for the thread to
+  // dequeue, and the thread reports a PTRACE_EVENT_STOP.
+  //
+  if (wrapPtrace(PTRACE_INTERRUPT, pid, nullptr, nullptr) < 0)
+    return Platform::TranslateError();
+
+  return kSuccess;
+}
+
+ErrorCode PTrace::listen(ProcessThreadId const &ptid) {
+  pid_t pid;
+  CHK(ptidToPid(ptid, pid));
+
+  if (wrapPtrace(PTRACE_LISTEN, pid, nullptr, nullptr) < 0)
+    return Platform::TranslateError();
 
   return kSuccess;
 }
@@ -101,6 +209,146 @@ ErrorCode PTrace::kill(ProcessThreadId const &ptid, int signal) {
   return kSuccess;
 }
 
+// Maximum number of page-sized remote segments handed to a single
+// process_vm_readv(2)/process_vm_writev(2) call.
+static size_t const kMaxBulkSegments = 64;
+
+// Transfers as much of [address, address + length) as a single cross-memory
+// syscall allows. The remote range is split on page boundaries so that a short
+// transfer always stops at the first page the kernel refused to access.
+// Returns the number of bytes transferred, or -1 with errno set.
+static ssize_t TransferBulk(pid_t pid, uintptr_t address, void *buffer,
+                            size_t length, bool write) {
+  size_t const pageSize = Platform::GetPageSize();
+  struct iovec remote[kMaxBulkSegments];
+  size_t nsegs = 0;
+  size_t total = 0;
+
+  while (total < length && nsegs < kMaxBulkSegments) {
+    uintptr_t start = address + total;
+    size_t size = std::min(length - total, pageSize - (start & (pageSize - 1)));
+    remote[nsegs].iov_base = reinterpret_cast<void *>(start);
+    remote[nsegs].iov_len = size;
+    total += size, nsegs++;
+  }
+
+  struct iovec local = {buffer, total};
+  if (write)
+    return ::process_vm_writev(pid, &local, 1, remote, nsegs, 0);
+  else
+    return ::process_vm_readv(pid, &local, 1, remote, nsegs, 0);
+}
+
+//
+// A PTrace object is owned by a single inferior; keeping /proc/<pid>/mem open
+// lets us move arbitrary-length buffers with a single pread/pwrite, and, like
+// ptrace itself, the kernel lets the tracer write to read-only mappings
+// through it (e.g. when inserting breakpoints in the text segment).
+//
+ErrorCode PTrace::openMemoryFile(ProcessId pid) {
+  closeMemoryFile();
+
+  int fd = ProcFS::OpenFd(pid, "mem", O_RDWR | O_CLOEXEC);
+  if (fd < 0) {
+    DS2LOG(Warning, "unable to open memory file of pid %d, error=%s", pid,
+           strerror(errno));
+    return Platform::TranslateError();
+  }
+
+  _memoryPid = pid;
+  _memoryFd = fd;
+
+  return kSuccess;
+}
+
+void PTrace::closeMemoryFile() {
+  if (_memoryFd < 0)
+    return;
+
+  ::close(_memoryFd);
+  _memoryPid = kAnyProcessId;
+  _memoryFd = -1;
+}
+
+// Returns the number of bytes transferred, or -1 if the memory file is not
+// available or the access failed.
+ssize_t PTrace::transferMemoryFile(uintptr_t address, void *buffer,
+                                   size_t length, bool write) {
+  for (int attempt = 0; attempt < 2 && _memoryFd >= 0; attempt++) {
+    ssize_t ret;
+    do {
+      if (write) {
+        ret = ::pwrite64(_memoryFd, buffer, length, address);
+      } else {
+        ret = ::pread64(_memoryFd, buffer, length, address);
+      }
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret != 0)
+      return ret;
+
+    // The descriptor is bound to the address space the inferior had when we
+    // opened it, and reads as empty once the inferior has called exec(2).
+    if (openMemoryFile(_memoryPid) != kSuccess)
+      break;
+  }
+
+  return -1;
+}
+
+ErrorCode PTrace::peekBytes(pid_t pid, uintptr_t address, void *buffer,
+                            size_t length, size_t &nread) {
+  uint8_t *bytes = static_cast<uint8_t *>(buffer);
+
+  nread = 0;
+  while (nread < length) {
+    union {
+      uintptr_t word;
+      uint8_t bytes[sizeof(uintptr_t)];
+    } data;
+    size_t ncopy = std::min(length - nread, sizeof(uintptr_t));
+
+    errno = 0;
+    data.word = wrapPtrace(PTRACE_PEEKDATA, pid, address + nread, nullptr);
+    if (errno != 0)
+      return Platform::TranslateError();
+
+    std::memcpy(bytes + nread, data.bytes, ncopy);
+    nread += ncopy;
+  }
+
+  return kSuccess;
+}
+
+ErrorCode PTrace::pokeBytes(pid_t pid, uintptr_t address, void const *buffer,
+                            size_t length, size_t &nwritten) {
+  uint8_t const *bytes = static_cast<uint8_t const *>(buffer);
+
+  nwritten = 0;
+  while (nwritten < length) {
+    union {
+      uintptr_t word;
+      uint8_t bytes[sizeof(uintptr_t)];
+    } data;
+    size_t ncopy = std::min(length - nwritten, sizeof(uintptr_t));
+
+    errno = 0;
+    if (ncopy < sizeof(uintptr_t)) {
+      data.word = wrapPtrace(PTRACE_PEEKDATA, pid, address + nwritten, nullptr);
+      if (errno != 0)
+        return Platform::TranslateError();
+    }
+
+    std::memcpy(data.bytes, bytes + nwritten, ncopy);
+    if (wrapPtrace(PTRACE_POKEDATA, pid, address + nwritten, data.word) < 0)
+      return Platform::TranslateError();
+
+    nwritten += ncopy;
+  }
+
+  return kSuccess;
+}
+
 ErrorCode PTrace::readBytes(ProcessThreadId const &ptid, Address const &address,
                             void *buffer, size_t length, size_t *count,
                             bool nullTerm) {
@@ -110,11 +358,6 @@ ErrorCode PTrace::readBytes(ProcessThreadId const &ptid, Address const &address,
   if (error != kSuccess)
     return error;
 
-  bool foundNull = false;
-  size_t nread = 0;
-  uintptr_t base = address;
-  uintptr_t *words = (uintptr_t *)buffer;
-
   if (length == 0 || buffer == nullptr) {
     if (count != nullptr) {
       *count = 0;
@@ -122,42 +365,61 @@ ErrorCode PTrace::readBytes(ProcessThreadId const &ptid, Address const &address,
     return kSuccess;
   }
 
-  while (length > 0) {
-    union {
-      uintptr_t word;
-      uint8_t bytes[sizeof(uintptr_t)];
-    } data;
-    size_t ncopy = std::min(length, sizeof(uintptr_t));
+  size_t const pageSize = Platform::GetPageSize();
+  uint8_t *bytes = static_cast<uint8_t *>(buffer);
+  bool foundNull = false;
+  size_t nread = 0;
 
-    errno = 0;
-    if (ncopy < sizeof(uintptr_t)) {
-      data.word = wrapPtrace(PTRACE_PEEKDATA, pid, base + nread, nullptr);
-      if (errno == 0) {
-        std::memcpy(words, data.bytes, ncopy);
-      }
-    } else {
-      *words = wrapPtrace(PTRACE_PEEKDATA, pid, base + nread, nullptr);
+  while (nread < length && !foundNull) {
+    uintptr_t base = address + nread;
+    size_t pageLeft = pageSize - (base & (pageSize - 1));
+
+    // Strings are read one page at a time so that we never touch memory past
+    // the page holding the terminator.
+    size_t chunk = length - nread;
+    if (nullTerm) {
+      chunk = std::min(chunk, pageLeft);
     }
 
-    if (errno != 0)
-      break;
+    size_t ncopy;
+    ssize_t ret = transferMemoryFile(base, bytes + nread, chunk, false);
+    if (ret <= 0) {
+      ret = TransferBulk(pid, base, bytes + nread, chunk, false);
+    }
+    if (ret > 0) {
+      ncopy = ret;
+    } else {
+      // process_vm_readv(2) does not bypass page protections like ptrace
+      // does; retry the faulting page with the word-sized loop.
+      error = peekBytes(pid, base, bytes + nread,
+                        std::min(length - nread, pageLeft), ncopy);
+    }
 
-    if (nullTerm && strnlen((char *)words, ncopy) < ncopy) {
-      foundNull = true;
-      break;
+    if (nullTerm) {
+      void *nul = std::memchr(bytes + nread, '\0', ncopy);
+      if (nul != nullptr) {
+        ncopy = static_cast<uint8_t *>(nul) - (bytes + nread);
+        foundNull = true;
+      }
     }
 
-    length -= ncopy, nread += ncopy, words++;
+    nread += ncopy;
+
+    if (error != kSuccess)
+      break;
   }
 
   if (count != nullptr) {
     *count = nread;
   }
 
-  if (errno != 0)
-    return Platform::TranslateError();
+  if (foundNull)
+    return kSuccess;
 
-  if (nullTerm && !foundNull)
+  if (error != kSuccess)
+    return error;
+
+  if (nullTerm)
     return kErrorNameTooLong;
 
   return kSuccess;
@@ -190,10 +452,6 @@ ErrorCode PTrace::writeMemory(ProcessThreadId const &ptid,
   if (error != kSuccess)
     return error;
 
-  size_t nwritten = 0;
-  uintptr_t base = address;
-  uintptr_t const *words = (uintptr_t const *)buffer;
-
   if (length == 0 || buffer == nullptr) {
     if (count != nullptr) {
       *count = 0;
@@ -201,38 +459,40 @@ ErrorCode PTrace::writeMemory(ProcessThreadId const &ptid,
     return kSuccess;
   }
 
-  while (length > 0) {
-    union {
-      uintptr_t word;
-      uint8_t bytes[sizeof(uintptr_t)];
-    } data;
-    size_t ncopy = std::min(length, sizeof(uintptr_t));
+  size_t const pageSize = Platform::GetPageSize();
+  uint8_t const *bytes = static_cast<uint8_t const *>(buffer);
+  size_t nwritten = 0;
 
-    errno = 0;
-    if (ncopy < sizeof(uintptr_t)) {
-      data.word = wrapPtrace(PTRACE_PEEKDATA, pid, base + nwritten, nullptr);
-      if (errno == 0) {
-        std::memcpy(data.bytes, words, ncopy);
-        wrapPtrace(PTRACE_POKEDATA, pid, base + nwritten, data.word);
-      }
+  while (nwritten < length) {
+    uintptr_t base = address + nwritten;
+    size_t pageLeft = pageSize - (base & (pageSize - 1));
+
+    size_t ncopy;
+    uint8_t *source = const_cast<uint8_t *>(bytes) + nwritten;
+    ssize_t ret = transferMemoryFile(base, source, length - nwritten, true);
+    if (ret <= 0) {
+      ret = TransferBulk(pid, base, source, length - nwritten, true);
+    }
+    if (ret > 0) {
+      ncopy = ret;
     } else {
-      wrapPtrace(PTRACE_POKEDATA, pid, base + nwritten, *words);
+      // process_vm_writev(2) refuses to write to read-only mappings such as
+      // the text segment; poke the faulting page a word at a time instead.
+      error = pokeBytes(pid, base, bytes + nwritten,
+                        std::min(length - nwritten, pageLeft), ncopy);
     }
 
-    if (errno != 0)
-      break;
+    nwritten += ncopy;
 
-    length -= ncopy, nwritten += ncopy, words++;
+    if (error != kSuccess)
+      break;
   }
 
-  if (errno != 0)
-    return Platform::TranslateError();
-
   if (count != nullptr) {
     *count = nwritten;
   }
 
-  return kSuccess;
+  return error;
 }
 
 ErrorCode PTrace::prepareAddressForResume(ProcessThreadId const &ptid,
@@ -240,6 +500,7 @@ ErrorCode PTrace::prepareAddressForResume(ProcessThreadId const &ptid,
                                           Address const &address) {
   if (address.valid()) {
     Architecture::CPUState state;
+    state.validSets = Architecture::kRegisterSetGP;
     ErrorCode error = readCPUState(ptid, pinfo, state);
     if (error != kSuccess) {
       return error;
@@ -350,6 +611,40 @@ ErrorCode PTrace::writeUserData(ProcessThreadId const &ptid, uint64_t offset,
   return kSuccess;
 }
 
+// Largest XSAVE area the CPU may use, the kernel tells how much of it it
+// actually transfers.
+static size_t GetMaxXStateSize() {
+  size_t size = sizeof(xfpregs_struct);
+  if (__get_cpuid_max(0, nullptr) >= 0xd) {
+    unsigned int eax, ebx, ecx, edx;
+    __cpuid_count(0xd, 0, eax, ebx, ecx, edx);
+    size = std::max<size_t>(size, ecx);
+  }
+  return size;
+}
+
+ErrorCode PTrace::readXState(pid_t pid, ByteVector &xstate) {
+  static size_t const maxSize = GetMaxXStateSize();
+  xstate.resize(maxSize);
+
+  struct iovec iov = {&xstate[0], xstate.size()};
+  if (wrapPtrace(PTRACE_GETREGSET, pid, NT_X86_XSTATE, &iov) < 0) {
+    xstate.clear();
+    return Platform::TranslateError();
+  }
+
+  xstate.resize(iov.iov_len);
+  return kSuccess;
+}
+
+ErrorCode PTrace::writeXState(pid_t pid, ByteVector const &xstate) {
+  struct iovec iov = {const_cast<uint8_t *>(&xstate[0]), xstate.size()};
+  if (wrapPtrace(PTRACE_SETREGSET, pid, NT_X86_XSTATE, &iov) < 0)
+    return Platform::TranslateError();
+
+  return kSuccess;
+}
+
 uintptr_t PTrace::readDebugReg(ProcessThreadId const &ptid, size_t idx) {
   return readUserData(ptid, computeDebugRegOffset(idx));
 }
@@ -559,6 +559,132 @@ pid_t ProcFS::GetProcessParentPid(pid_t pid) {
   return ppid;
 }
 
+//
+// Parses one line of the /proc/XYZ/maps file, i.e.:
+// start-end perms offset major:minor inode [path]
+//
+static bool ParseMemoryMapLine(char const *line, char const *eol,
+                               MemoryRegionInfo &region) {
+  char *eptr;
+
+  uint64_t start = std::strtoull(line, &eptr, 16);
+  if (*eptr++ != '-')
+    return false;
+  uint64_t end = std::strtoull(eptr, &eptr, 16);
+  if (*eptr++ != ' ' || eol - eptr < 5 || end < start)
+    return false;
+
+  region.start = start;
+  region.length = end - start;
+  region.protection = 0;
+  if (eptr[0] == 'r')
+    region.protection |= kProtectionRead;
+  if (eptr[1] == 'w')
+    region.protection |= kProtectionWrite;
+  if (eptr[2] == 'x')
+    region.protection |= kProtectionExecute;
+  eptr += 4;
+
+  region.backingFileOffset = std::strtoull(eptr, &eptr, 16);
+  std::strtoul(eptr, &eptr, 16);
+  if (*eptr++ != ':')
+    return false;
+  std::strtoul(eptr, &eptr, 16);
+  region.backingFileInode = std::strtoull(eptr, &eptr, 10);
+  if (eptr > eol)
+    return false;
+
+  while (eptr < eol && std::isspace(*eptr))
+    eptr++;
+  region.backingFile.assign(eptr, eol - eptr);
+
+  return true;
+}
+
+bool ProcFS::ReadMemoryMap(pid_t pid, MemoryRegionInfo::Collection &regions) {
+  int fd = OpenFd(pid, "maps");
+  if (fd < 0)
+    return false;
+
+  //
+  // Slurp the whole file before parsing it; the kernel only returns
+  // a page worth of lines per read() anyway.
+  //
+  std::string data;
+  size_t size = 0;
+  for (;;) {
+    data.resize(size + 0x10000);
+    ssize_t nread = ::read(fd, &data[size], data.size() - size);
+    if (nread < 0 && errno == EINTR)
+      continue;
+    if (nread < 0) {
+      ::close(fd);
+      return false;
+    }
+    if (nread == 0)
+      break;
+    size += nread;
+  }
+  ::close(fd);
+  data.resize(size);
+
+  regions.clear();
+
+  char const *line = data.c_str();
+  while (*line != '\0') {
+    char const *eol = std::strchr(line, '\n');
+    if (eol == nullptr) {
+      eol = line + std::strlen(line);
+    }
+
+    MemoryRegionInfo region;
+    if (ParseMemoryMapLine(line, eol, region)) {
+      regions.push_back(region);
+    }
+
+    line = (*eol != '\0') ? eol + 1 : eol;
+  }
+
+  return true;
+}
+
+bool ProcFS::ReadPageMap(pid_t pid, uint64_t page, size_t count,
+                         std::vector<uint64_t> &entries) {
+  int fd = OpenFd(pid, "pagemap");
+  if (fd < 0)
+    return false;
+
+  entries.resize(count);
+
+  auto buffer = reinterpret_cast<char *>(entries.data());
+  size_t length = count * sizeof(uint64_t);
+  off64_t offset = page * sizeof(uint64_t);
+  while (length > 0) {
+    ssize_t nread = ::pread64(fd, buffer, length, offset);
+    if (nread < 0 && errno == EINTR)
+      continue;
+    if (nread <= 0) {
+      ::close(fd);
+      return false;
+    }
+    buffer += nread, offset += nread, length -= nread;
+  }
+
+  ::close(fd);
+  return true;
+}
+
+bool ProcFS::ClearSoftDirtyBits(pid_t pid) {
+  int fd = OpenFd(pid, "clear_refs", O_WRONLY);
+  if (fd < 0)
+    return false;
+
+  // 4 only clears the soft-dirty bits, leaving the referenced bits alone.
+  bool success = (::write(fd, "4", 1) == 1);
+  ::close(fd);
+  return success;
+}
+
 bool ProcFS::GetProcessELFInfo(pid_t pid, ELFInfo &info) {
   //
   // On Linux, due to the binfmt_misc module, we need to
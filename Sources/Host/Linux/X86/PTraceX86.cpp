@@ -13,6 +13,8 @@
 #include "DebugServer2/Host/Linux/ExtraWrappers.h"
 #include "DebugServer2/Host/Platform.h"
 
+#include <algorithm>
+#include <cstring>
 #include <elf.h>
 #include <sys/ptrace.h>
 #include <sys/uio.h>
@@ -115,24 +117,41 @@ ErrorCode PTrace::readCPUState(ProcessThreadId const &ptid, ProcessInfo const &,
   //
   // Read GPRs
   //
-  user_regs_struct gprs;
-  if (wrapPtrace(PTRACE_GETREGS, pid, nullptr, &gprs) < 0)
-    return Platform::TranslateError();
+  if (state.validSets & Architecture::kRegisterSetGP) {
+    user_regs_struct gprs;
+    if (wrapPtrace(PTRACE_GETREGS, pid, nullptr, &gprs) < 0)
+      return Platform::TranslateError();
 
-  Architecture::X86::user_to_state32(state, gprs);
+    Architecture::X86::user_to_state32(state, gprs);
+  }
 
   //
-  // Read SSE and AVX
+  // Read x87, SSE and AVX, only when they were asked for. The legacy FXSAVE
+  // area is enough for x87 and SSE, AVX needs the whole XSAVE area.
   //
-  struct xfpregs_struct xfpregs;
-  struct iovec fpregs_iovec;
-  fpregs_iovec.iov_base = &xfpregs;
-  fpregs_iovec.iov_len = sizeof(xfpregs);
-
-  // If this call fails, don't return failure, since AVX may not be available
-  // on this CPU
-  if (wrapPtrace(PTRACE_GETREGSET, pid, NT_X86_XSTATE, &fpregs_iovec) == 0) {
+  if (state.validSets &
+      (Architecture::kRegisterSetFP | Architecture::kRegisterSetAVX)) {
+    struct xfpregs_struct xfpregs;
+    std::memset(&xfpregs, 0, sizeof(xfpregs));
+    std::memset(&state.xsave, 0, sizeof(state.xsave));
+
+    // If this call fails, don't return failure, since AVX may not be
+    // available on this CPU
+    if ((state.validSets & Architecture::kRegisterSetAVX) &&
+        readXState(pid, state.xsaveArea) == kSuccess) {
+      std::memcpy(&xfpregs, &state.xsaveArea[0],
+                  std::min(state.xsaveArea.size(), sizeof(xfpregs)));
+      state.xsave.size = state.xsaveArea.size();
+      state.xsave.xfeatures = xfpregs.header.mask;
+      std::memcpy(&state.xsave.xcr0, &state.xsaveArea[kXSaveXCR0Offset],
+                  sizeof(state.xsave.xcr0));
+    } else if (wrapPtrace(PTRACE_GETFPXREGS, pid, nullptr, &xfpregs.fpregs) <
+               0) {
+      return Platform::TranslateError();
+    }
+
     user_to_state32(state, xfpregs);
+    state.validSets |= Architecture::kRegisterSetFP;
   }
 
   return kSuccess;
@@ -150,29 +169,48 @@ ErrorCode PTrace::writeCPUState(ProcessThreadId const &ptid,
   //
   // Write GPRs
   //
-  user_regs_struct gprs;
-  Architecture::X86::state32_to_user(gprs, state);
+  if (state.validSets & Architecture::kRegisterSetGP) {
+    user_regs_struct gprs;
+    Architecture::X86::state32_to_user(gprs, state);
 
-  if (wrapPtrace(PTRACE_SETREGS, pid, nullptr, &gprs) < 0)
-    return Platform::TranslateError();
+    if (wrapPtrace(PTRACE_SETREGS, pid, nullptr, &gprs) < 0)
+      return Platform::TranslateError();
+  }
 
   //
-  // Write SSE and AVX
+  // Write x87, SSE and AVX. The kernel merges the legacy FXSAVE area into
+  // the XSAVE area on its own, so the latter is only needed for AVX.
   //
-  struct xfpregs_struct xfpregs;
-  struct iovec fpregs_iovec;
-  fpregs_iovec.iov_base = &xfpregs;
-  fpregs_iovec.iov_len = sizeof(xfpregs);
-
-  // We need this read to fill the kernel header (xfpregs_struct.xstate_hdr)
-  // TODO - add this header to CPUState so we don't need this read
-  if (wrapPtrace(PTRACE_GETREGSET, pid, NT_X86_XSTATE, &fpregs_iovec) < 0) {
-    // If we fail to read the AVX register info, still write the SSE regs
-    fpregs_iovec.iov_len = sizeof(xfpregs.fpregs);
+  if (state.validSets &
+      (Architecture::kRegisterSetFP | Architecture::kRegisterSetAVX)) {
+    struct xfpregs_struct xfpregs;
+    std::memset(&xfpregs, 0, sizeof(xfpregs));
+
+    // The area has to be written whole; start from the one the registers
+    // were read from, which holds the components CPUState doesn't carry.
+    ByteVector xstate;
+    bool writeXSave = (state.validSets & Architecture::kRegisterSetAVX) &&
+                      state.xsave.size != 0;
+    if (writeXSave) {
+      xstate = state.xsaveArea;
+      std::memcpy(&xfpregs, &xstate[0],
+                  std::min(xstate.size(), sizeof(xfpregs)));
+    }
+
+    state32_to_user(xfpregs, state);
+
+    if (writeXSave) {
+      // Components missing from the header are reset by the kernel.
+      xfpregs.header.mask |=
+          kXFeatureMaskFPSSE | (kXFeatureMaskAVX & state.xsave.xcr0);
+      std::memcpy(&xstate[0], &xfpregs,
+                  std::min(xstate.size(), sizeof(xfpregs)));
+      CHK(writeXState(pid, xstate));
+    } else if (wrapPtrace(PTRACE_SETFPXREGS, pid, nullptr, &xfpregs.fpregs) <
+               0) {
+      return Platform::TranslateError();
+    }
   }
-  state32_to_user(xfpregs, state);
-
-  wrapPtrace(PTRACE_SETREGSET, pid, NT_X86_XSTATE, &fpregs_iovec);
 
   return kSuccess;
 }
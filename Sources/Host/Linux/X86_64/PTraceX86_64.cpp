@@ -13,6 +13,8 @@
 #include "DebugServer2/Host/Linux/ExtraWrappers.h"
 #include "DebugServer2/Host/Platform.h"
 
+#include <algorithm>
+#include <cstring>
 #include <elf.h>
 #include <sys/ptrace.h>
 #include <sys/uio.h>
@@ -20,6 +22,8 @@
 
 #define super ds2::Host::POSIX::PTrace
 
+using ds2::Architecture::X86_64::XSaveLayout;
+
 namespace ds2 {
 namespace Host {
 namespace Linux {
@@ -223,37 +227,57 @@ ErrorCode PTrace::readCPUState(ProcessThreadId const &ptid,
   if (error != kSuccess)
     return error;
 
+  state.is32 = (pinfo.pointerSize == sizeof(uint32_t));
+
   //
   // Read GPRs
   //
-  user_regs_struct gprs;
-  if (wrapPtrace(PTRACE_GETREGS, pid, nullptr, &gprs) < 0)
-    return Platform::TranslateError();
+  if (state.validSets & Architecture::kRegisterSetGP) {
+    user_regs_struct gprs;
+    if (wrapPtrace(PTRACE_GETREGS, pid, nullptr, &gprs) < 0)
+      return Platform::TranslateError();
 
-  if (pinfo.pointerSize == sizeof(uint32_t)) {
-    state.is32 = true;
-    Architecture::X86::user_to_state32(state.state32, gprs);
-  } else {
-    state.is32 = false;
-    Architecture::X86::user_to_state64(state.state64, gprs);
+    if (state.is32) {
+      Architecture::X86::user_to_state32(state.state32, gprs);
+    } else {
+      Architecture::X86::user_to_state64(state.state64, gprs);
+    }
   }
 
   //
-  // Read SSE and AVX
-  //
-  struct xfpregs_struct xfpregs;
-  struct iovec fpregs_iovec;
-  fpregs_iovec.iov_base = &xfpregs;
-  fpregs_iovec.iov_len = sizeof(xfpregs);
+  // Read x87, SSE and AVX, only when they were asked for. The legacy FXSAVE
+  // area is enough for x87 and SSE, AVX needs the whole XSAVE area.
+  //
+  if (state.validSets &
+      (Architecture::kRegisterSetFP | Architecture::kRegisterSetAVX)) {
+    struct xfpregs_struct xfpregs;
+    std::memset(&xfpregs, 0, sizeof(xfpregs));
+
+    XSaveLayout &xsave = state.is32 ? state.state32.xsave : state.state64.xsave;
+    std::memset(&xsave, 0, sizeof(xsave));
+
+    // If this call fails, don't return failure, since AVX may not be
+    // available on this CPU
+    if ((state.validSets & Architecture::kRegisterSetAVX) &&
+        readXState(pid, state.xsaveArea) == kSuccess) {
+      std::memcpy(&xfpregs, &state.xsaveArea[0],
+                  std::min(state.xsaveArea.size(), sizeof(xfpregs)));
+      xsave.size = state.xsaveArea.size();
+      xsave.xfeatures = xfpregs.header.mask;
+      std::memcpy(&xsave.xcr0, &state.xsaveArea[kXSaveXCR0Offset],
+                  sizeof(xsave.xcr0));
+    } else if (wrapPtrace(PTRACE_GETFPREGS, pid, nullptr, &xfpregs.fpregs) <
+               0) {
+      return Platform::TranslateError();
+    }
 
-  // If this call fails, don't return failure, since AVX may not be available
-  // on this CPU
-  if (wrapPtrace(PTRACE_GETREGSET, pid, NT_X86_XSTATE, &fpregs_iovec) == 0) {
-    if (pinfo.pointerSize == sizeof(uint32_t)) {
+    if (state.is32) {
       user_to_state32(state.state32, xfpregs);
     } else {
       user_to_state64(state.state64, xfpregs);
     }
+
+    state.validSets |= Architecture::kRegisterSetFP;
   }
 
   return kSuccess;
@@ -276,38 +300,59 @@ ErrorCode PTrace::writeCPUState(ProcessThreadId const &ptid,
   //
   // Write GPRs
   //
-  user_regs_struct gprs;
-  if (state.is32) {
-    Architecture::X86::state32_to_user(gprs, state.state32);
-  } else {
-    Architecture::X86::state64_to_user(gprs, state.state64);
-  }
+  if (state.validSets & Architecture::kRegisterSetGP) {
+    user_regs_struct gprs;
+    if (state.is32) {
+      Architecture::X86::state32_to_user(gprs, state.state32);
+    } else {
+      Architecture::X86::state64_to_user(gprs, state.state64);
+    }
 
-  if (wrapPtrace(PTRACE_SETREGS, pid, nullptr, &gprs) < 0)
-    return Platform::TranslateError();
+    if (wrapPtrace(PTRACE_SETREGS, pid, nullptr, &gprs) < 0)
+      return Platform::TranslateError();
+  }
 
   //
-  // Write SSE and AVX
+  // Write x87, SSE and AVX. The kernel merges the legacy FXSAVE area into
+  // the XSAVE area on its own, so the latter is only needed for AVX.
   //
-  struct xfpregs_struct xfpregs;
-  struct iovec fpregs_iovec;
-  fpregs_iovec.iov_base = &xfpregs;
-  fpregs_iovec.iov_len = sizeof(xfpregs);
+  if (state.validSets &
+      (Architecture::kRegisterSetFP | Architecture::kRegisterSetAVX)) {
+    struct xfpregs_struct xfpregs;
+    std::memset(&xfpregs, 0, sizeof(xfpregs));
 
-  // We need this read to fill the kernel header (xfpregs_struct.xstate_hdr)
-  // TODO - add this header to CPUState so we don't need this read
-  if (wrapPtrace(PTRACE_GETREGSET, pid, NT_X86_XSTATE, &fpregs_iovec) < 0) {
-    // If we fail to read the AVX register info, still write the SSE regs
-    fpregs_iovec.iov_len = sizeof(xfpregs.fpregs);
-  }
+    XSaveLayout const &xsave =
+        state.is32 ? state.state32.xsave : state.state64.xsave;
 
-  if (state.is32) {
-    state32_to_user(xfpregs, state.state32);
-  } else {
-    state64_to_user(xfpregs, state.state64);
-  }
+    // The area has to be written whole; start from the one the registers
+    // were read from, which holds the components CPUState doesn't carry.
+    ByteVector xstate;
+    bool writeXSave =
+        (state.validSets & Architecture::kRegisterSetAVX) && xsave.size != 0;
+    if (writeXSave) {
+      xstate = state.xsaveArea;
+      std::memcpy(&xfpregs, &xstate[0],
+                  std::min(xstate.size(), sizeof(xfpregs)));
+    }
 
-  wrapPtrace(PTRACE_SETREGSET, pid, NT_X86_XSTATE, &fpregs_iovec);
+    if (state.is32) {
+      state32_to_user(xfpregs, state.state32);
+    } else {
+      state64_to_user(xfpregs, state.state64);
+    }
+
+    if (writeXSave) {
+      // Components missing from the header are reset by the kernel.
+      xfpregs.header.mask |=
+          kXFeatureMaskFPSSE | (kXFeatureMaskAVX & xsave.xcr0);
+      std::memcpy(&xstate[0], &xfpregs,
+                  std::min(xstate.size(), sizeof(xfpregs)));
+      CHK(writeXState(pid, xstate));
+    } else if (wrapPtrace(PTRACE_SETFPREGS, pid, nullptr, &xfpregs.fpregs) <
+               0) {
+      return Platform::TranslateError();
+    }
+  }
 
   return kSuccess;
 }
@@ -14,10 +14,12 @@
 
 #include <cerrno>
 #include <climits>
+#include <csignal>
 #include <cstring>
 #include <fcntl.h>
 #include <grp.h>
 #include <netdb.h>
+#include <pthread.h>
 #include <pwd.h>
 #include <string>
 #include <unistd.h>
@@ -33,7 +35,15 @@ namespace ds2 {
 namespace Host {
 
 void Platform::Initialize() {
-  // Nothing to do here.
+  //
+  // Keep SIGCHLD pending until a thread takes it with sigwait, rather than
+  // have it discarded. Threads inherit the mask, so this has to be done before
+  // any is created; processes we spawn get it back unblocked.
+  //
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, SIGCHLD);
+  ::pthread_sigmask(SIG_BLOCK, &set, nullptr);
 }
 
 size_t Platform::GetPageSize() {
@@ -21,6 +21,7 @@
 
 #include <cerrno>
 #include <climits>
+#include <csignal>
 #include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
@@ -475,6 +476,12 @@ ErrorCode ProcessSpawner::run(std::function<bool()> preExecAction) {
             (new std::string(env.first + '=' + env.second))->c_str()));
       environment.push_back(nullptr);
 
+      // ds2 keeps SIGCHLD blocked, see Platform::Initialize.
+      sigset_t set;
+      sigemptyset(&set);
+      sigaddset(&set, SIGCHLD);
+      ::sigprocmask(SIG_UNBLOCK, &set, nullptr);
+
       if (!preExecAction()) {
         DS2LOG(Error, "pre exec action failed");
         return kErrorUnknown;
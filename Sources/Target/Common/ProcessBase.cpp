@@ -12,21 +12,33 @@
 
 #include "DebugServer2/Target/ProcessBase.h"
 #include "DebugServer2/Architecture/CPUState.h"
+#include "DebugServer2/Host/Platform.h"
 #include "DebugServer2/SoftwareBreakpointManager.h"
 #include "DebugServer2/Target/Thread.h"
 #include "DebugServer2/Utils/Log.h"
 #include "DebugServer2/Utils/Stringify.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <list>
 
+using ds2::Host::Platform;
 using ds2::Utils::Stringify;
 
 namespace ds2 {
 namespace Target {
 
+static uint32_t NextImageGeneration() {
+  static std::atomic<uint32_t> generation(0);
+  return ++generation;
+}
+
 ProcessBase::ProcessBase()
     : _terminated(false), _flags(0), _pid(kAnyProcessId), _loadBase(),
-      _entryPoint(), _currentThread(nullptr) {}
+      _entryPoint(), _imageGeneration(NextImageGeneration()),
+      _stopGeneration(0), _nonStop(false), _currentThread(nullptr),
+      _memoryCacheHits(0), _memoryCacheMisses(0), _dirtyPageTracking(false) {}
 
 ProcessBase::~ProcessBase() {
   for (auto thread : _threads) {
@@ -58,6 +70,13 @@ void ProcessBase::cleanup() {
   _currentThread = nullptr;
 }
 
+void ProcessBase::resetImage() {
+  _imageGeneration = NextImageGeneration();
+  _loadBase.clear();
+  _entryPoint.clear();
+  flushMemoryCache();
+}
+
 ErrorCode ProcessBase::initialize(ProcessId pid, uint32_t flags) {
   if (_pid != kAnyProcessId) {
     return kErrorAlreadyExist;
@@ -107,11 +126,13 @@ ErrorCode ProcessBase::suspend() {
         break;
 
       case kErrorProcessNotFound:
+        // The thread exited before we got to reap it, keep stopping the
+        // other ones.
         DS2LOG(Debug,
                "tried to suspended tid %" PRI_PID " which is already dead",
                thread->tid());
         removeThread(thread->tid());
-        return error;
+        break;
 
       default:
         DS2LOG(Warning, "failed suspending tid %" PRI_PID ", error=%s",
@@ -217,17 +238,143 @@ ErrorCode ProcessBase::readMemoryBuffer(Address const &address, size_t length,
 
   buffer.resize(length);
 
-  size_t nread;
+  // Short reads are not an error as long as we could read something; the
+  // remote side will re-issue the request for the remaining bytes.
+  size_t nread = 0;
   ErrorCode error = readMemory(address, buffer.data(), length, &nread);
-  if (error != kSuccess) {
+  if (error != kSuccess && nread == 0) {
     buffer.clear();
     return error;
   }
 
   buffer.resize(nread);
+
+  for (auto bpm : std::list<BreakpointManager *>{softwareBreakpointManager(),
+                                                 hardwareBreakpointManager()}) {
+    if (bpm != nullptr && bpm->enabled()) {
+      bpm->restoreInstructions(address, buffer.data(), buffer.size());
+    }
+  }
+
   return kSuccess;
 }
 
+// Past this many cached pages, misses are read straight into the caller's
+// buffer; large dumps are rarely read twice in the same stop.
+static size_t const kMemoryCacheMaxPages = 1024;
+
+ErrorCode ProcessBase::readMemoryCached(Address const &address, void *buffer,
+                                        size_t length, size_t *nread,
+                                        MemoryReader const &reader) {
+  // Running threads can write to memory at any time.
+  if (_nonStop)
+    return reader(address, buffer, length, nread);
+
+  size_t const pageSize = Platform::GetPageSize();
+  uint8_t *bytes = static_cast<uint8_t *>(buffer);
+  uint64_t const start = address;
+  ErrorCode error = kSuccess;
+  size_t done = 0;
+
+  while (done < length) {
+    uint64_t page = (start + done) & ~static_cast<uint64_t>(pageSize - 1);
+    size_t offset = (start + done) - page;
+    size_t ncopy = std::min(length - done, pageSize - offset);
+
+    auto it = _memoryCache.find(page);
+    if (it != _memoryCache.end()) {
+      _memoryCacheHits++;
+      std::memcpy(bytes + done, it->second.data() + offset, ncopy);
+      done += ncopy;
+      continue;
+    }
+
+    _memoryCacheMisses++;
+
+    // Fetch the whole run of missing pages covered by the request at once.
+    uint64_t end = page + pageSize;
+    while (end < start + length && _memoryCache.find(end) == _memoryCache.end())
+      end += pageSize;
+
+    size_t npages = (end - page) / pageSize;
+    if (_memoryCache.size() + npages > kMemoryCacheMaxPages) {
+      size_t nfilled = 0;
+      size_t want = std::min<uint64_t>(end, start + length) - (start + done);
+      error = reader(start + done, bytes + done, want, &nfilled);
+      done += nfilled;
+      if (error != kSuccess)
+        break;
+      continue;
+    }
+
+    ByteVector run(end - page);
+    size_t nfilled = 0;
+    error = reader(page, run.data(), run.size(), &nfilled);
+
+    for (size_t n = 0; n + pageSize <= nfilled; n += pageSize) {
+      _memoryCache[page + n].assign(run.begin() + n,
+                                    run.begin() + n + pageSize);
+    }
+
+    // Hand out whatever part of the request we got, even on failure.
+    uint64_t runEnd = std::min<uint64_t>(end, start + length);
+    uint64_t readEnd = std::min<uint64_t>(page + nfilled, runEnd);
+    if (readEnd > start + done) {
+      std::memcpy(bytes + done, run.data() + offset, readEnd - (start + done));
+      done = readEnd - start;
+    }
+
+    if (readEnd < runEnd) {
+      if (error == kSuccess) {
+        error = kErrorInvalidAddress;
+      }
+      break;
+    }
+
+    error = kSuccess;
+  }
+
+  if (nread != nullptr) {
+    *nread = done;
+  }
+
+  return (done == length) ? kSuccess : error;
+}
+
+void ProcessBase::updateMemoryCache(Address const &address, void const *buffer,
+                                    size_t length) {
+  if (_memoryCache.empty())
+    return;
+
+  size_t const pageSize = Platform::GetPageSize();
+  uint8_t const *bytes = static_cast<uint8_t const *>(buffer);
+  uint64_t const start = address;
+  size_t done = 0;
+
+  while (done < length) {
+    uint64_t page = (start + done) & ~static_cast<uint64_t>(pageSize - 1);
+    size_t offset = (start + done) - page;
+    size_t ncopy = std::min(length - done, pageSize - offset);
+
+    auto it = _memoryCache.find(page);
+    if (it != _memoryCache.end()) {
+      std::memcpy(it->second.data() + offset, bytes + done, ncopy);
+    }
+
+    done += ncopy;
+  }
+}
+
+void ProcessBase::flushMemoryCache() {
+  if (_memoryCache.empty())
+    return;
+
+  DS2LOG(Debug, "flushing %zu cached pages, %" PRIu64 " hits, %" PRIu64
+                " misses so far",
+         _memoryCache.size(), _memoryCacheHits, _memoryCacheMisses);
+  _memoryCache.clear();
+}
+
 ErrorCode ProcessBase::writeMemoryBuffer(Address const &address,
                                          ByteVector const &buffer,
                                          size_t *nwritten) {
@@ -260,6 +407,11 @@ void ProcessBase::insert(ThreadBase *thread) {
            .second)
     return;
 
+  // Threads come and go while others are stopped in non-stop mode.
+  if (_nonStop) {
+    _stopGeneration++;
+  }
+
   DS2LOG(Debug, "[new Thread %" PRI_PTR " (LWP %" PRIu64 ")]",
          PRI_PTR_CAST(thread), (uint64_t)thread->tid());
 }
@@ -272,6 +424,10 @@ void ProcessBase::removeThread(ThreadId tid) {
   Thread *thread = it->second;
   _threads.erase(it);
 
+  if (_nonStop) {
+    _stopGeneration++;
+  }
+
   DS2LOG(Debug, "[delete Thread %" PRI_PTR " (LWP %" PRIu64 ") exited]",
          PRI_PTR_CAST(thread), (uint64_t)thread->tid());
 
@@ -284,6 +440,8 @@ ErrorCode ProcessBase::beforeResume() {
   if (!isAlive())
     return kErrorProcessNotFound;
 
+  _stopGeneration++;
+
   //
   // Enable breakpoints.
   //
@@ -294,10 +452,36 @@ ErrorCode ProcessBase::beforeResume() {
     }
   }
 
+  //
+  // Drop the memory cache last: enabling software breakpoints reads and
+  // writes memory, which must not leave breakpoint opcodes behind.
+  //
+  flushMemoryCache();
+
+  //
+  // Start tracking writes only now so that inserting breakpoints isn't
+  // reported. Removing them in afterResume writes to their pages again, so
+  // these are always reported dirty: we can't tell whether the inferior
+  // wrote to them too.
+  //
+  if (_dirtyPageTracking) {
+    if (clearDirtyPages() != kSuccess) {
+      DS2LOG(Warning, "unable to clear soft-dirty bits, disabling dirty page "
+                      "tracking");
+      setDirtyPageTracking(false);
+    }
+  }
+
   return kSuccess;
 }
 
 ErrorCode ProcessBase::afterResume() {
+  //
+  // Pages read between beforeResume and the actual resume (e.g. to prepare
+  // a software single step) were cached before the inferior ran.
+  //
+  flushMemoryCache();
+
   if (!isAlive()) {
     return kSuccess;
   }
@@ -315,12 +499,70 @@ ErrorCode ProcessBase::afterResume() {
         DS2LOG(Debug, "hit breakpoint for tid %" PRI_PID, it.second->tid());
       }
     }
+
     bpm->disable();
   }
 
   return kSuccess;
 }
 
+ErrorCode ProcessBase::beforeThreadResume(Thread *thread) {
+  if (!isAlive())
+    return kErrorProcessNotFound;
+
+  _stopGeneration++;
+
+  //
+  // Breakpoints stay inserted as long as any thread runs.
+  //
+  for (auto bpm : std::list<BreakpointManager *>{softwareBreakpointManager(),
+                                                 hardwareBreakpointManager()}) {
+    if (bpm != nullptr && !bpm->enabled()) {
+      bpm->enable();
+    }
+  }
+
+  flushMemoryCache();
+  return kSuccess;
+}
+
+ErrorCode ProcessBase::afterThreadStop(Thread *thread) {
+  _stopGeneration++;
+  flushMemoryCache();
+
+  if (!isAlive())
+    return kSuccess;
+
+  bool running = false;
+  for (auto it : _threads) {
+    if (it.second->state() == Thread::kRunning ||
+        it.second->state() == Thread::kStepped) {
+      running = true;
+    }
+  }
+
+  for (auto bpm : std::list<BreakpointManager *>{softwareBreakpointManager(),
+                                                 hardwareBreakpointManager()}) {
+    if (bpm == nullptr || !bpm->enabled()) {
+      continue;
+    }
+
+    BreakpointManager::Site site;
+    if (bpm->hit(thread, site) >= 0) {
+      DS2LOG(Debug, "hit breakpoint for tid %" PRI_PID, thread->tid());
+    }
+
+    //
+    // Temporary breakpoints only go away once every thread is stopped.
+    //
+    if (!running) {
+      bpm->disable();
+    }
+  }
+
+  return kSuccess;
+}
+
 SoftwareBreakpointManager *ProcessBase::softwareBreakpointManager() const {
   if (!_softwareBreakpointManager) {
 #if defined(ARCH_ARM) || defined(ARCH_ARM64)
@@ -9,18 +9,23 @@
 //
 
 #include "DebugServer2/Target/ThreadBase.h"
+#include "DebugServer2/Host/Platform.h"
 #include "DebugServer2/Target/Process.h"
 
+using ds2::Host::Platform;
+
 namespace ds2 {
 namespace Target {
 
 ThreadBase::ThreadBase(Process *process, ThreadId tid)
-    : _process(process), _tid(tid), _state(kStopped) {
+    : _process(process), _tid(tid), _state(kStopped), _nameGeneration(0),
+      _nameStopGeneration(0) {
   // When threads are created, they're stopped at the entry point waiting for
   // the debugger to continue them.
   _stopInfo.event = StopInfo::kEventStop;
   _stopInfo.reason = StopInfo::kReasonThreadEntry;
   _process->insert(this);
+  _creationStopGeneration = _process->stopGeneration();
 }
 
 ErrorCode ThreadBase::modifyRegisters(
@@ -30,5 +35,29 @@ ErrorCode ThreadBase::modifyRegisters(
   action(state);
   return writeCPUState(state);
 }
+
+std::string const &ThreadBase::name() {
+  uint32_t stopGeneration = _process->stopGeneration();
+
+  // Image generations start at 1, 0 never matches. Threads usually name
+  // themselves right after they start, the name read at the stop they were
+  // created before may still be the one they inherited.
+  if (_nameGeneration != _process->imageGeneration() ||
+      (_nameStopGeneration == _creationStopGeneration &&
+       _nameStopGeneration != stopGeneration)) {
+    _name = Platform::GetThreadName(_process->pid(), _tid);
+    _nameGeneration = _process->imageGeneration();
+    _nameStopGeneration = stopGeneration;
+  }
+  return _name;
+}
+
+ErrorCode ThreadBase::readCPURegisterSets(Architecture::CPUState &state,
+                                          uint32_t sets) {
+  CHK(readCPUState(state));
+  if ((state.validSets & sets) == sets)
+    return kSuccess;
+  return fetchCPURegisterSets(state, sets);
+}
 }
 }
@@ -270,7 +270,7 @@ ErrorCode Process::allocateMemory(size_t size, uint32_t protection,
   // We need to know if the process is running in Thumb or ARM mode.
   //
   Architecture::CPUState state;
-  error = ptrace().readCPUState(_currentThread->tid(), info, state);
+  error = _currentThread->readCPUState(state);
   if (error != kSuccess)
     return error;
 
@@ -289,6 +289,10 @@ ErrorCode Process::allocateMemory(size_t size, uint32_t protection,
   //
   // Code inject and execute
   //
+  error = _currentThread->flushCPUState();
+  if (error != kSuccess)
+    return error;
+
   error = ptrace().execute(_currentThread->tid(), info, &codestr[0],
                            codestr.size(), *address);
   if (error != kSuccess)
@@ -310,7 +314,7 @@ ErrorCode Process::deallocateMemory(uint64_t address, size_t size) {
   // We need to know if the process is running in Thumb or ARM mode.
   //
   Architecture::CPUState state;
-  error = ptrace().readCPUState(_currentThread->tid(), info, state);
+  error = _currentThread->readCPUState(state);
   if (error != kSuccess)
     return error;
 
@@ -329,6 +333,10 @@ ErrorCode Process::deallocateMemory(uint64_t address, size_t size) {
   //
   // Code inject and execute
   //
+  error = _currentThread->flushCPUState();
+  if (error != kSuccess)
+    return error;
+
   uint64_t result = 0;
   error = ptrace().execute(_currentThread->tid(), info, &codestr[0],
                            codestr.size(), result);
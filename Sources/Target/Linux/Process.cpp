@@ -20,12 +20,17 @@
 #include "DebugServer2/Utils/Log.h"
 #include "DebugServer2/Utils/Stringify.h"
 
+#include <algorithm>
 #include <cerrno>
+#include <chrono>
 #include <csignal>
 #include <cstdio>
 #include <cstdlib>
 #include <elf.h>
+#include <iterator>
 #include <limits>
+#include <map>
+#include <set>
 #include <sys/ptrace.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -41,6 +46,16 @@ namespace ds2 {
 namespace Target {
 namespace Linux {
 
+ErrorCode Process::initialize(ProcessId pid, uint32_t flags) {
+  // Processes we spawn wait for us to seize them before calling exec, see
+  // Host::Linux::PTrace::traceMe.
+  if (flags & kFlagNewProcess) {
+    CHK(_ptrace.traceChild(pid));
+  }
+
+  return super::initialize(pid, flags);
+}
+
 ErrorCode Process::attach(int waitStatus) {
   if (waitStatus <= 0) {
     ErrorCode error = ptrace().attach(_pid);
@@ -95,9 +110,30 @@ ErrorCode Process::attach(int waitStatus) {
   _currentThread = new Thread(this, _pid);
   _currentThread->updateStopInfo(waitStatus);
 
+  //
+  // An interrupt stops a thread without a reason; report the initial stop of
+  // an attached process the way the SIGSTOP of PTRACE_ATTACH used to be.
+  //
+  if (_currentThread->_stopInfo.event == StopInfo::kEventNone) {
+    _currentThread->_stopInfo.event = StopInfo::kEventStop;
+    _currentThread->_stopInfo.reason = StopInfo::kReasonTrap;
+    _currentThread->_stopInfo.signal = SIGSTOP;
+  }
+
+  //
+  // Memory accesses fall back to ptrace if we can't get a descriptor on the
+  // process memory.
+  //
+  _ptrace.openMemoryFile(_pid);
+
   return kSuccess;
 }
 
+ErrorCode Process::detach() {
+  _ptrace.closeMemoryFile();
+  return super::detach();
+}
+
 static pid_t blocking_waitpid(pid_t pid, int *status, int flags) {
   pid_t ret;
   do {
@@ -120,19 +156,42 @@ ErrorCode Process::checkMemoryErrorCode(uint64_t address) {
   return kSuccess;
 }
 
+ErrorCode Process::setNonStop(bool enable) {
+  _nonStop = enable;
+  return kSuccess;
+}
+
 ErrorCode Process::wait() {
   int status, signal;
   ProcessInfo info;
   ThreadId tid;
+  ThreadId lastTid = (_currentThread != nullptr) ? _currentThread->tid() : 0;
 
   // We have at least one thread when we start waiting on a process.
   DS2ASSERT(!_threads.empty());
 
+  // The process ran since the map was built; mmap() or exec() may have
+  // changed it.
+  flushMemoryMap();
+
   while (!_threads.empty()) {
-    tid = blocking_waitpid(-1, &status, __WALL);
+    tid = blocking_waitpid(-1, &status, __WALL | (_nonStop ? WNOHANG : 0));
+
+    if (tid == 0) {
+      //
+      // Nothing happened to the running threads. The debugger keeps talking
+      // to the thread it last looked at in the meantime.
+      //
+      _currentThread = thread(lastTid);
+      if (_currentThread == nullptr && !_threads.empty()) {
+        _currentThread = _threads.begin()->second;
+      }
+      return kErrorNotFound;
+    }
+
     DS2LOG(Debug, "wait tid=%d status=%#x", tid, status);
 
-    if (tid <= 0)
+    if (tid < 0)
       return kErrorProcessNotFound;
 
     auto threadIt = _threads.find(tid);
@@ -147,9 +206,14 @@ ErrorCode Process::wait() {
       }
 
       // A new thread has appeared that we didn't know about. Create the
-      // Thread object and return.
+      // Thread object and return; in non-stop mode, let it run like its
+      // creator does.
       DS2LOG(Debug, "creating new thread tid=%d", tid);
       _currentThread = new Thread(this, tid);
+      if (_nonStop) {
+        _currentThread->resume();
+        goto continue_waiting;
+      }
       return kSuccess;
     } else {
       _currentThread = threadIt->second;
@@ -159,6 +223,8 @@ ErrorCode Process::wait() {
 
     switch (_currentThread->_stopInfo.event) {
     case StopInfo::kEventNone:
+      // This also puts threads that entered a group-stop back in it without
+      // reporting the stop, see Thread::resume.
       _currentThread->resume();
       goto continue_waiting;
 
@@ -186,6 +252,12 @@ ErrorCode Process::wait() {
     case StopInfo::kEventStop:
       signal = _currentThread->_stopInfo.signal;
 
+      if (status >> 8 == (SIGTRAP | (PTRACE_EVENT_EXEC << 8))) {
+        DS2LOG(Debug, "tid %d replaced the process image", tid);
+        resetImage();
+        updateInfo();
+      }
+
       DS2LOG(Debug, "stopped tid=%d status=%#x signal=%s", tid, status,
              Stringify::Signal(signal));
 
@@ -208,7 +280,8 @@ ErrorCode Process::wait() {
     continue;
   }
 
-  if (!(WIFEXITED(status) || WIFSIGNALED(status)) || tid != _pid) {
+  if (!_nonStop && (!(WIFEXITED(status) || WIFSIGNALED(status)) ||
+                    tid != _pid)) {
     //
     // Suspend the process, this must be done after updating
     // the thread trap info.
@@ -218,11 +291,107 @@ ErrorCode Process::wait() {
 
   if ((WIFEXITED(status) || WIFSIGNALED(status)) && tid == _pid) {
     _terminated = true;
+    _ptrace.closeMemoryFile();
   }
 
   return kSuccess;
 }
 
+ErrorCode Process::suspend() {
+  auto start = std::chrono::steady_clock::now();
+
+  //
+  // Interrupt all the running threads first and collect their stops
+  // afterwards so that they stop concurrently rather than one after the
+  // other. Any ptrace stop consumes a pending interrupt, so the first event
+  // of each interrupted thread is the one that stops it.
+  //
+  std::set<ThreadId> pending;
+  std::set<ThreadId> terminated;
+
+  for (auto const &it : _threads) {
+    Thread *thread = it.second;
+
+    switch (thread->state()) {
+    case Thread::kInvalid:
+      DS2BUG("trying to suspend tid %" PRI_PID " in state %s", thread->tid(),
+             Stringify::ThreadState(thread->state()));
+      break;
+
+    case Thread::kStepped:
+    case Thread::kStopped:
+      break;
+
+    case Thread::kTerminated:
+      terminated.insert(thread->tid());
+      break;
+
+    case Thread::kRunning: {
+      ErrorCode error = _ptrace.suspend(ProcessThreadId(_pid, thread->tid()));
+      switch (error) {
+      case kSuccess:
+        pending.insert(thread->tid());
+        break;
+
+      case kErrorProcessNotFound:
+        // The thread exited before we got to reap it, keep stopping the
+        // other ones.
+        DS2LOG(Debug,
+               "tried to suspend tid %" PRI_PID " which is already dead",
+               thread->tid());
+        terminated.insert(thread->tid());
+        break;
+
+      default:
+        DS2LOG(Warning, "failed suspending tid %" PRI_PID ", error=%s",
+               thread->tid(), Stringify::Error(error));
+        return error;
+      }
+    } break;
+    }
+  }
+
+  size_t interrupted = pending.size();
+
+  while (!pending.empty()) {
+    int status;
+    ThreadId tid = blocking_waitpid(-1, &status, __WALL);
+    if (tid <= 0)
+      return kErrorProcessNotFound;
+
+    auto threadIt = _threads.find(tid);
+    if (threadIt == _threads.end()) {
+      // Threads created while we were stopping the others report their
+      // initial stop here, see Process::wait.
+      if (!(WIFEXITED(status) || WIFSIGNALED(status))) {
+        DS2LOG(Debug, "creating new thread tid=%d", tid);
+        new Thread(this, tid);
+      }
+      continue;
+    }
+
+    Thread *thread = threadIt->second;
+    thread->updateStopInfo(status);
+    pending.erase(tid);
+
+    if (thread->state() == Thread::kTerminated) {
+      terminated.insert(tid);
+    }
+  }
+
+  for (auto tid : terminated) {
+    removeThread(tid);
+  }
+
+  DS2LOG(Debug, "stopped %zu threads in %lldus", interrupted,
+         static_cast<long long>(
+             std::chrono::duration_cast<std::chrono::microseconds>(
+                 std::chrono::steady_clock::now() - start)
+                 .count()));
+
+  return kSuccess;
+}
+
 ErrorCode Process::terminate() {
   ErrorCode error = super::terminate();
   if (error == kSuccess || error == kErrorProcessNotFound) {
@@ -305,90 +474,162 @@ ErrorCode Process::updateInfo() {
   return kSuccess;
 }
 
+ErrorCode Process::updateMemoryMap() {
+  if (!_memoryMap.empty())
+    return kSuccess;
+
+  if (!ProcFS::ReadMemoryMap(_pid, _memoryMap))
+    return Platform::TranslateError();
+
+  DS2LOG(Debug, "indexed %zu memory regions", _memoryMap.size());
+  return kSuccess;
+}
+
 ErrorCode Process::getMemoryRegionInfo(Address const &address,
                                        MemoryRegionInfo &info) {
   if (!address.valid())
     return kErrorInvalidArgument;
 
+  CHK(updateMemoryMap());
+
   info.clear();
 
-  FILE *fp = ProcFS::OpenFILE(_pid, "maps");
-  if (fp == nullptr) {
-    return Platform::TranslateError();
-  }
+  //
+  // Find the last region starting at or before the address; the address is
+  // either inside it or in the hole that follows it.
+  //
+  auto it = std::upper_bound(_memoryMap.begin(), _memoryMap.end(),
+                             address.value(),
+                             [](uint64_t value, MemoryRegionInfo const &mri) {
+                               return value < mri.start.value();
+                             });
 
   uint64_t last = 0;
-  bool found = false;
-
-  while (!found) {
-    // Each line can contain one path and some additional addresses and
-    // such, so PATH_MAX * 2 should be enough.
-    char buf[PATH_MAX * 2];
-    uint64_t start, end;
-    char r, w, x, p;
-    uint64_t offset;
-    unsigned int devMinor, devMajor;
-    uint64_t inode;
-    int nread;
-
-    if (std::fgets(buf, sizeof(buf), fp) == nullptr)
-      break;
+  if (it != _memoryMap.begin()) {
+    MemoryRegionInfo const &prev = *std::prev(it);
+    if (address.value() < prev.start.value() + prev.length) {
+      info = prev;
+      return kSuccess;
+    }
+    last = prev.start.value() + prev.length;
+  }
+
+  //
+  // A hole.
+  //
+  info.start = last;
+  if (it != _memoryMap.end()) {
+    info.length = it->start.value() - last;
+    return kSuccess;
+  }
 
-    if (std::sscanf(buf, "%" PRIx64 "-%" PRIx64 " %c%c%c%c %" PRIx64
-                         " %x:%x %" PRIu64 " %n",
-                    &start, &end, &r, &w, &x, &p, &offset, &devMinor, &devMajor,
-                    &inode, &nread) != 10) {
+  //
+  // We need to obtain the end of the address space, first
+  // we need to know if it's 64-bit.
+  //
+  ErrorCode error = updateInfo();
+  if (error != kSuccess && error != kErrorAlreadyExist)
+    return error;
+
+  if (CPUTypeIs64Bit(_info.cpuType)) {
+    info.length = std::numeric_limits<uint64_t>::max() - info.start;
+  } else {
+    info.length = std::numeric_limits<uint32_t>::max() - info.start;
+  }
+
+  return kSuccess;
+}
+
+ErrorCode Process::enumerateMappedFiles(
+    std::function<void(MappedFileInfo const &)> const &cb) {
+  CHK(updateMemoryMap());
+
+  //
+  // A file is reported at the address where its first page is mapped,
+  // and spans up to the end of its last mapping.
+  //
+  std::vector<MappedFileInfo> files;
+  std::map<std::string, size_t> indices;
+
+  for (auto const &mri : _memoryMap) {
+    if (mri.backingFileInode == 0 || mri.backingFile.empty() ||
+        mri.backingFile[0] != '/')
       continue;
-    }
 
-    if (address >= last && address <= start) {
-      //
-      // A hole.
-      //
-      info.start = last;
-      info.length = start - last;
-      found = true;
-    } else if (address >= start && address < end) {
-      //
-      // A defined region.
-      //
-      info.start = start;
-      info.length = end - start;
-      info.protection = 0;
-      if (r == 'r')
-        info.protection |= ds2::kProtectionRead;
-      if (w == 'w')
-        info.protection |= ds2::kProtectionWrite;
-      if (x == 'x')
-        info.protection |= ds2::kProtectionExecute;
-      while (buf[nread] != '\0' && std::isspace(buf[nread]))
-        ++nread;
-      info.backingFile = buf + nread;
-      info.backingFileOffset = offset;
-      info.backingFileInode = inode;
-      found = true;
+    uint64_t end = mri.start.value() + mri.length;
+    auto it = indices.find(mri.backingFile);
+    if (it == indices.end()) {
+      if (mri.backingFileOffset != 0)
+        continue;
+      indices[mri.backingFile] = files.size();
+      files.push_back({mri.backingFile, mri.start.value(), mri.length});
     } else {
-      last = end;
+      MappedFileInfo &file = files[it->second];
+      file.size = end - file.baseAddress;
     }
   }
-  std::fclose(fp);
 
-  if (!found) {
-    info.start = last;
+  for (auto const &file : files) {
+    cb(file);
+  }
 
+  return kSuccess;
+}
+
+ErrorCode Process::setDirtyPageTracking(bool enable) {
+  if (enable && !_dirtyPageTracking) {
     //
-    // We need to obtain the end of the address space, first
-    // we need to know if it's 64-bit.
+    // Kernels built without soft-dirty support accept clear_refs but never
+    // set the bit. Check it on one of our own stack pages, which we just
+    // wrote and whose soft-dirty bits were never cleared.
     //
-    ErrorCode error = updateInfo();
-    if (error != kSuccess && error != kErrorAlreadyExist)
-      return error;
-
-    if (CPUTypeIs64Bit(_info.cpuType)) {
-      info.length = std::numeric_limits<uint64_t>::max() - info.start;
-    } else {
-      info.length = std::numeric_limits<uint32_t>::max() - info.start;
+    volatile uint64_t probe = 0;
+    probe = probe + 1;
+
+    uint64_t pageSize = Platform::GetPageSize();
+    std::vector<uint64_t> entries;
+    if (!ProcFS::ReadPageMap(::getpid(),
+                             reinterpret_cast<uintptr_t>(&probe) / pageSize, 1,
+                             entries) ||
+        (entries[0] & Host::Linux::kPageMapSoftDirty) == 0) {
+      DS2LOG(Warning, "soft-dirty page tracking is not available");
+      return kErrorUnsupported;
     }
+
+    CHK(clearDirtyPages());
+  }
+
+  _dirtyPageTracking = enable;
+  return kSuccess;
+}
+
+ErrorCode Process::clearDirtyPages() {
+  if (!ProcFS::ClearSoftDirtyBits(_pid))
+    return Platform::TranslateError();
+
+  return kSuccess;
+}
+
+ErrorCode Process::getDirtyPages(Address const &address, size_t length,
+                                 std::vector<bool> &dirty) {
+  if (!_dirtyPageTracking)
+    return kErrorInvalidArgument;
+  if (!address.valid() || length == 0)
+    return kErrorInvalidArgument;
+
+  uint64_t pageSize = Platform::GetPageSize();
+  uint64_t first = address.value() / pageSize;
+  uint64_t last = (address.value() + length - 1) / pageSize;
+
+  std::vector<uint64_t> entries;
+  if (!ProcFS::ReadPageMap(_pid, first, last - first + 1, entries))
+    return Platform::TranslateError();
+
+  // Pages holding software breakpoints are always soft-dirty, see
+  // ProcessBase::beforeResume.
+  dirty.resize(entries.size());
+  for (size_t n = 0; n < entries.size(); n++) {
+    dirty[n] = (entries[n] & Host::Linux::kPageMapSoftDirty) != 0;
   }
 
   return kSuccess;
@@ -403,8 +644,19 @@ ErrorCode Process::executeCode(ByteVector const &codestr, uint64_t &result) {
     return error;
   }
 
+  // The injected code runs from the registers the kernel knows about.
+  error = _currentThread->flushCPUState();
+  if (error != kSuccess) {
+    return error;
+  }
+
   error = ptrace().execute(_currentThread->tid(), info, &codestr[0],
                            codestr.size(), result);
+
+  // The injected code is usually there to change the address space layout.
+  flushMemoryCache();
+  flushMemoryMap();
+
   if (error != kSuccess) {
     return error;
   }
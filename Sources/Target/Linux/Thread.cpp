@@ -32,7 +32,32 @@ namespace ds2 {
 namespace Target {
 namespace Linux {
 
-Thread::Thread(Process *process, ThreadId tid) : super(process, tid) {}
+Thread::Thread(Process *process, ThreadId tid)
+    : super(process, tid), _groupStop(false) {}
+
+ErrorCode Thread::step(int signal, Address const &address) {
+  // Stepping a thread explicitly takes it out of its group-stop.
+  _groupStop = false;
+  return super::step(signal, address);
+}
+
+ErrorCode Thread::resume(int signal, Address const &address) {
+  if (_state != kStopped || !_groupStop || signal != 0) {
+    return super::resume(signal, address);
+  }
+
+  //
+  // Resuming a group-stopped thread with PTRACE_CONT would end the job-control
+  // stop of the inferior behind its back; put it back in its group-stop
+  // instead. We still get notified when it gets a SIGCONT.
+  //
+  CHK(flushCPUState());
+  auto &ptrace = static_cast<Host::Linux::PTrace &>(process()->ptrace());
+  CHK(ptrace.listen(ProcessThreadId(process()->pid(), tid())));
+  _state = kRunning;
+  invalidateCPUState();
+  return kSuccess;
+}
 
 void Thread::fillWatchpointData() {
   HardwareBreakpointManager *hwBpm = process()->hardwareBreakpointManager();
@@ -66,6 +91,10 @@ void Thread::fillWatchpointData() {
 ErrorCode Thread::updateStopInfo(int waitStatus) {
   super::updateStopInfo(waitStatus);
 
+  _groupStop = WIFSTOPPED(waitStatus) &&
+               waitStatus >> 16 == PTRACE_EVENT_STOP &&
+               WSTOPSIG(waitStatus) != SIGTRAP;
+
   switch (_stopInfo.event) {
   case StopInfo::kEventExit:
   case StopInfo::kEventKill:
@@ -100,6 +129,20 @@ ErrorCode Thread::updateStopInfo(int waitStatus) {
     //     mark the thread as stopped for a trap;
     // (5) the inferior received a SIGTRAP. This is usually because of a
     //     breakpoint, single step or such;
+    // (6) the thread called execve(2); with PTRACE_O_TRACEEXEC the kernel
+    //     reports it as a PTRACE_EVENT_EXEC stop instead of sending the
+    //     process a SIGTRAP, and we report it the way that SIGTRAP was;
+    // (7) the thread reports a PTRACE_EVENT_STOP, either because we
+    //     interrupted it with PTRACE_INTERRUPT to suspend it, or because it
+    //     entered a group-stop (WSTOPSIG(status) is then the stop signal
+    //     rather than SIGTRAP, see _groupStop). Both are treated like (2),
+    //     and resume puts group-stopped threads back in their group-stop.
+    //     There is no siginfo_t to read for a group-stop.
+
+    if (waitStatus >> 16 == PTRACE_EVENT_STOP) { // (7)
+      _stopInfo.event = StopInfo::kEventNone;
+      return kSuccess;
+    }
 
     siginfo_t si;
     ProcessThreadId ptid(process()->pid(), tid());
@@ -112,6 +155,8 @@ ErrorCode Thread::updateStopInfo(int waitStatus) {
 
     if (waitStatus >> 8 == (SIGTRAP | (PTRACE_EVENT_CLONE << 8))) { // (1)
       _stopInfo.event = StopInfo::kEventNone;
+    } else if (waitStatus >> 8 == (SIGTRAP | (PTRACE_EVENT_EXEC << 8))) { // (6)
+      _stopInfo.reason = StopInfo::kReasonTrap;
     } else if (si.si_code == SI_TKILL && si.si_pid == getpid()) { // (2)
       // The only signal we are supposed to send to the inferior is a SIGSTOP.
       DS2ASSERT(_stopInfo.signal == SIGSTOP);
@@ -159,6 +204,13 @@ ErrorCode Thread::updateStopInfo(int waitStatus) {
 }
 
 void Thread::updateState() {
+  // Thread states follow the ptrace events we get in Process::wait and the
+  // requests we make to threads, reading procfs for each thread every time
+  // the threads get enumerated doesn't scale to processes with thousands of
+  // threads. See reconcileState.
+}
+
+void Thread::reconcileState() {
   if (!process()->isAlive()) {
     _state = kTerminated;
     return;
@@ -438,6 +438,17 @@ ErrorCode ELFProcess::updateInfo() {
   return kSuccess;
 }
 
+//
+// Drop what we cached about the image the process was running.
+//
+void ELFProcess::resetImage() {
+  super::resetImage();
+
+  _auxiliaryVector.clear();
+  _sharedLibraryInfoAddress.clear();
+  _info.pid = kAnyProcessId;
+}
+
 //
 // Inheriting class should call this method and then
 // read data into _auxiliaryVector buffer; if this method
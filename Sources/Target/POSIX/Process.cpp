@@ -13,14 +13,17 @@
 #include "DebugServer2/Target/Process.h"
 #include "DebugServer2/BreakpointManager.h"
 #include "DebugServer2/Host/POSIX/PTrace.h"
+#include "DebugServer2/Host/Platform.h"
 #include "DebugServer2/Target/Thread.h"
 #include "DebugServer2/Utils/Log.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <csignal>
 #include <sys/wait.h>
 #include <unistd.h>
 
+using ds2::Host::Platform;
 using ds2::Host::ProcessSpawner;
 
 #define super ds2::Target::ProcessBase
@@ -55,6 +58,9 @@ ErrorCode Process::initialize(ProcessId pid, uint32_t flags) {
 ErrorCode Process::detach() {
   prepareForDetach();
 
+  // Registers written while stopped are only sent to the kernel on resume.
+  enumerateThreads([](Thread *thread) { thread->flushCPUState(); });
+
   CHK(ptrace().detach(_pid));
 
   cleanup();
@@ -78,20 +84,66 @@ bool Process::isAlive() const { return (_pid > 0 && ::kill(_pid, 0) == 0); }
 
 ErrorCode Process::readString(Address const &address, std::string &str,
                               size_t length, size_t *count) {
-  auto id = _currentThread == nullptr ? _pid : _currentThread->tid();
-  return ptrace().readString(id, address, str, length, count);
+  size_t const pageSize = Platform::GetPageSize();
+  uint64_t const start = address;
+  ByteVector buffer;
+
+  //
+  // Go through the memory cache one page at a time so that we never read
+  // past the page holding the terminator.
+  //
+  str.clear();
+  while (str.size() < length) {
+    uint64_t base = start + str.size();
+    size_t chunk =
+        std::min(length - str.size(), pageSize - (base & (pageSize - 1)));
+
+    size_t nread = 0;
+    buffer.resize(chunk);
+    ErrorCode error = readMemory(base, buffer.data(), chunk, &nread);
+
+    auto nul = std::find(buffer.begin(), buffer.begin() + nread, '\0');
+    str.append(buffer.begin(), nul);
+
+    if (nul != buffer.begin() + nread || error != kSuccess) {
+      if (count != nullptr) {
+        *count = str.size();
+      }
+      return (nul != buffer.begin() + nread) ? kSuccess : error;
+    }
+  }
+
+  if (count != nullptr) {
+    *count = str.size();
+  }
+
+  return kErrorNameTooLong;
 }
 
 ErrorCode Process::readMemory(Address const &address, void *data, size_t length,
                               size_t *count) {
   auto id = _currentThread == nullptr ? _pid : _currentThread->tid();
-  return ptrace().readMemory(id, address, data, length, count);
+  return readMemoryCached(
+      address, data, length, count,
+      [this, id](Address const &address, void *data, size_t length,
+                 size_t *count) {
+        return ptrace().readMemory(id, address, data, length, count);
+      });
 }
 
 ErrorCode Process::writeMemory(Address const &address, void const *data,
                                size_t length, size_t *count) {
   auto id = _currentThread == nullptr ? _pid : _currentThread->tid();
-  return ptrace().writeMemory(id, address, data, length, count);
+
+  size_t nwritten = 0;
+  ErrorCode error = ptrace().writeMemory(id, address, data, length, &nwritten);
+  updateMemoryCache(address, data, nwritten);
+
+  if (count != nullptr) {
+    *count = nwritten;
+  }
+
+  return error;
 }
 
 ErrorCode Process::wait() { return ptrace().wait(_pid, nullptr); }
@@ -13,7 +13,9 @@
 #include "DebugServer2/Architecture/ARM/SoftwareSingleStep.h"
 #endif
 #include "DebugServer2/Target/Process.h"
+#include "DebugServer2/Utils/Log.h"
 
+#include <cinttypes>
 #include <sys/wait.h>
 
 #define super ds2::Target::ThreadBase
@@ -23,22 +25,77 @@ namespace Target {
 namespace POSIX {
 
 Thread::Thread(ds2::Target::Process *process, ThreadId tid)
-    : super(process, tid) {}
+    : super(process, tid), _cpuStateDirtySets(0), _cpuStateCacheHits(0),
+      _cpuStateCacheMisses(0), _cpuStateWritesSaved(0) {
+  _cpuState.validSets = 0;
+}
 
 ErrorCode Thread::readCPUState(Architecture::CPUState &state) {
-  // TODO cache CPU state
-  ProcessInfo info;
-  ErrorCode error;
+  // Floating point and vector registers are only fetched when a caller
+  // asks for them with readCPURegisterSets.
+  return fetchCPURegisterSets(state, Architecture::kRegisterSetGP);
+}
+
+ErrorCode Thread::fetchCPURegisterSets(Architecture::CPUState &state,
+                                       uint32_t sets) {
+  uint32_t missingSets = sets & ~_cpuState.validSets;
+  if (missingSets == 0) {
+    _cpuStateCacheHits++;
+    state = _cpuState;
+    return kSuccess;
+  }
+
+  // Targets that can't read register sets separately would overwrite
+  // pending changes.
+  ErrorCode error = flushCPUState();
+  if (error != kSuccess)
+    return error;
 
+  ProcessInfo info;
   error = _process->getInfo(info);
   if (error != kSuccess)
     return error;
 
-  return process()->ptrace().readCPUState(
-      ProcessThreadId(process()->pid(), tid()), info, state);
+  uint32_t validSets = _cpuState.validSets;
+  _cpuState.validSets = missingSets;
+  error = process()->ptrace().readCPUState(
+      ProcessThreadId(process()->pid(), tid()), info, _cpuState);
+  if (error != kSuccess) {
+    _cpuState.validSets = 0;
+    return error;
+  }
+
+  _cpuStateCacheMisses++;
+  _cpuState.validSets |= validSets;
+  state = _cpuState;
+  return kSuccess;
 }
 
 ErrorCode Thread::writeCPUState(Architecture::CPUState const &state) {
+  return writeCPURegisterSets(state, state.validSets);
+}
+
+ErrorCode Thread::writeCPURegisterSets(Architecture::CPUState const &state,
+                                       uint32_t sets) {
+  // Pending changes to register sets that |state| doesn't hold must reach
+  // the target before the cache is replaced.
+  if (_cpuStateDirtySets & ~state.validSets) {
+    CHK(flushCPUState());
+  } else if (_cpuStateDirtySets != 0) {
+    _cpuStateWritesSaved++;
+  }
+
+  // The other sets in |state| come from the cache and are left as they
+  // were, clean or not.
+  _cpuState = state;
+  _cpuStateDirtySets |= sets & state.validSets;
+  return kSuccess;
+}
+
+ErrorCode Thread::flushCPUState() {
+  if (_cpuStateDirtySets == 0)
+    return kSuccess;
+
   ProcessInfo info;
   ErrorCode error;
 
@@ -46,8 +103,22 @@ ErrorCode Thread::writeCPUState(Architecture::CPUState const &state) {
   if (error != kSuccess)
     return error;
 
-  return process()->ptrace().writeCPUState(
-      ProcessThreadId(process()->pid(), tid()), info, state);
+  // Only write back the register sets that were modified.
+  uint32_t validSets = _cpuState.validSets;
+  _cpuState.validSets = _cpuStateDirtySets;
+  error = process()->ptrace().writeCPUState(
+      ProcessThreadId(process()->pid(), tid()), info, _cpuState);
+  _cpuState.validSets = validSets;
+  if (error != kSuccess)
+    return error;
+
+  _cpuStateDirtySets = 0;
+
+  DS2LOG(Debug,
+         "tid %" PRI_PID " register cache: %" PRIu64 " hits, %" PRIu64
+         " misses, %" PRIu64 " writes saved",
+         tid(), _cpuStateCacheHits, _cpuStateCacheMisses, _cpuStateWritesSaved);
+  return kSuccess;
 }
 
 ErrorCode Thread::terminate() {
@@ -109,11 +180,14 @@ ErrorCode Thread::step(int signal, Address const &address) {
 
   DS2LOG(Debug, "stepping tid %d", tid());
 
+  CHK(flushCPUState());
+
   ProcessInfo info;
   CHK(process()->getInfo(info));
   CHK(process()->ptrace().step(ProcessThreadId(process()->pid(), tid()), info,
                                signal, address));
   _state = kStepped;
+  invalidateCPUState();
   return kSuccess;
 }
 #endif
@@ -124,6 +198,10 @@ ErrorCode Thread::resume(int signal, Address const &address) {
   if (_state == kStopped || _state == kStepped) {
     ProcessInfo info;
 
+    error = flushCPUState();
+    if (error != kSuccess)
+      return error;
+
     error = process()->getInfo(info);
     if (error != kSuccess)
       return error;
@@ -133,6 +211,7 @@ ErrorCode Thread::resume(int signal, Address const &address) {
     if (error == kSuccess) {
       _state = kRunning;
       _stopInfo.signal = 0;
+      invalidateCPUState();
     }
   } else if (_state == kTerminated) {
     error = kErrorProcessNotFound;
@@ -143,6 +222,7 @@ ErrorCode Thread::resume(int signal, Address const &address) {
 
 ErrorCode Thread::updateStopInfo(int waitStatus) {
   _stopInfo.clear();
+  invalidateCPUState();
 
   if (WIFEXITED(waitStatus)) {
     _stopInfo.event = StopInfo::kEventExit;
@@ -0,0 +1,66 @@
+//
+// Copyright (c) 2014-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the University of Illinois/NCSA Open
+// Source License found in the LICENSE file in the root directory of this
+// source tree. An additional grant of patent rights can be found in the
+// PATENTS file in the same directory.
+//
+
+#include "DebugServer2/Utils/CRC32.h"
+
+namespace ds2 {
+namespace Utils {
+
+namespace {
+
+// Slicing-by-8 tables: kTable[0] is the classic byte-at-a-time table and
+// kTable[n][i] is the CRC of byte i followed by n zero bytes, which lets us
+// fold eight input bytes per iteration with independent lookups.
+struct CRC32Tables {
+  uint32_t table[8][256];
+
+  CRC32Tables() {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i << 24;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04c11db7 : (crc << 1);
+      }
+      table[0][i] = crc;
+    }
+
+    for (int n = 1; n < 8; n++) {
+      for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = table[n - 1][i];
+        table[n][i] = (crc << 8) ^ table[0][crc >> 24];
+      }
+    }
+  }
+};
+
+CRC32Tables const kTables;
+}
+
+uint32_t CRC32(void const *data, size_t length, uint32_t crc) {
+  auto const &T = kTables.table;
+  auto p = static_cast<uint8_t const *>(data);
+
+  while (length >= 8) {
+    crc ^= (static_cast<uint32_t>(p[0]) << 24) |
+           (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+    crc = T[7][crc >> 24] ^ T[6][(crc >> 16) & 0xff] ^
+          T[5][(crc >> 8) & 0xff] ^ T[4][crc & 0xff] ^ T[3][p[4]] ^
+          T[2][p[5]] ^ T[1][p[6]] ^ T[0][p[7]];
+    p += 8, length -= 8;
+  }
+
+  while (length-- > 0) {
+    crc = (crc << 8) ^ T[0][(crc >> 24) ^ *p++];
+  }
+
+  return crc;
+}
+}
+}
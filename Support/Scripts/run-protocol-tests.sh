@@ -0,0 +1,50 @@
+#!/usr/bin/env bash
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+# This script runs the packet round-trip tests found in Support/Testing/Protocol
+# against the ds2 binary in the current directory. Extra arguments are passed
+# to unittest, e.g. `run-protocol-tests.sh test_memory` to run a single file.
+
+top="$(git rev-parse --show-toplevel)"
+build_dir="$PWD"
+
+source "$top/Support/Scripts/common.sh"
+
+[ "$(uname)" == "Linux" ] || die "The protocol tests require a Linux host environment."
+[ -x "$build_dir/ds2" ]   || die "Unable to find a ds2 binary in the current directory."
+
+tests_dir="$top/Support/Testing/Protocol"
+inferiors_dir="$build_dir/protocol-inferiors"
+mkdir -p "$inferiors_dir"
+
+cc="${CC:-cc}"
+cflags=(-std=gnu99 -g -O0 -pthread)
+
+# ds2 looks for the ELF header in the mapping that holds the entry point,
+# which recent linkers map separately from the code by default.
+layout=(-no-pie -Wl,-z,noseparate-code)
+if echo "int main() { return 0; }" | "$cc" "${layout[@]}" -x c -o /dev/null - 2>/dev/null; then
+  cflags+=("${layout[@]}")
+fi
+
+for source in "$tests_dir"/Inferiors/*.c; do
+  "$cc" "${cflags[@]}" -o "$inferiors_dir/$(basename "$source" .c)" "$source"
+done
+
+cd "$tests_dir"
+export DS2="$build_dir/ds2"
+export DS2_TEST_INFERIORS="$inferiors_dir"
+
+if [ $# -eq 0 ]; then
+  python3 -m unittest discover -v -p 'test_*.py'
+else
+  python3 -m unittest -v "$@"
+fi
@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+# This script measures how the ds2 binary in the current directory scales with
+# the number of threads of the inferior: thread list, jThreadsInfo,
+# qThreadStopInfo and stop reply times, and interrupt latency. Extra arguments
+# go to Support/Testing/Protocol/benchmark_threads.py, e.g.
+# `run-thread-benchmark.sh --threads 1000 10000 --repeat 10`.
+
+top="$(git rev-parse --show-toplevel)"
+build_dir="$PWD"
+
+source "$top/Support/Scripts/common.sh"
+
+[ "$(uname)" == "Linux" ] || die "The thread benchmark requires a Linux host environment."
+[ -x "$build_dir/ds2" ]   || die "Unable to find a ds2 binary in the current directory."
+
+tests_dir="$top/Support/Testing/Protocol"
+# Optimized, unlike the inferiors of the protocol tests.
+inferiors_dir="$build_dir/benchmark-inferiors"
+mkdir -p "$inferiors_dir"
+
+cc="${CC:-cc}"
+cflags=(-std=gnu99 -O2 -pthread)
+
+# See run-protocol-tests.sh.
+layout=(-no-pie -Wl,-z,noseparate-code)
+if echo "int main() { return 0; }" | "$cc" "${layout[@]}" -x c -o /dev/null - 2>/dev/null; then
+  cflags+=("${layout[@]}")
+fi
+
+"$cc" "${cflags[@]}" -o "$inferiors_dir/threads" "$tests_dir/Inferiors/threads.c"
+
+cd "$tests_dir"
+export DS2="$build_dir/ds2"
+export DS2_TEST_INFERIORS="$inferiors_dir"
+
+python3 benchmark_threads.py "$@"
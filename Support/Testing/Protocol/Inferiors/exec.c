@@ -0,0 +1,36 @@
+//
+// Copyright (c) 2014-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the University of Illinois/NCSA Open
+// Source License found in the LICENSE file in the root directory of this
+// source tree. An additional grant of patent rights can be found in the
+// PATENTS file in the same directory.
+//
+
+// Reports its pid and stops, then replaces itself with the memory inferior
+// next to it, which stops again once it has reported its own values.
+
+#include "report.h"
+
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+
+int main(int argc, char **argv) {
+  report_open(argc, argv);
+
+  char path[PATH_MAX];
+  char *slash = strrchr(argv[0], '/');
+  size_t length = slash == NULL ? 0 : (size_t)(slash - argv[0]) + 1;
+  if (length + sizeof("memory") > sizeof(path))
+    return 1;
+  memcpy(path, argv[0], length);
+  strcpy(path + length, "memory");
+
+  report("pid", getpid());
+  report_stop();
+
+  execl(path, path, argv[1], (char *)NULL);
+  return 1;
+}
@@ -0,0 +1,70 @@
+//
+// Copyright (c) 2014-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the University of Illinois/NCSA Open
+// Source License found in the LICENSE file in the root directory of this
+// source tree. An additional grant of patent rights can be found in the
+// PATENTS file in the same directory.
+//
+
+// Maps a buffer of kPages pages filled with a known pattern and a needle,
+// reports where everything is and stops. At the second stop, one byte of the
+// page at `changed` has been modified by the inferior itself, and kRegions
+// new regions with alternating protections start at `regions`.
+
+#include "report.h"
+
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define kPages 16
+#define kRegions 1024
+
+static char const kNeedle[] = "ds2-needle-0123456789";
+
+// Never called; the tests overwrite its code.
+int unused(int x) { return x * 3 + 1; }
+
+int main(int argc, char **argv) {
+  report_open(argc, argv);
+
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t size = kPages * page;
+  unsigned char *buffer = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (buffer == MAP_FAILED)
+    return 1;
+
+  for (size_t n = 0; n < size; n++)
+    buffer[n] = (unsigned char)(n * 7 + 3);
+
+  unsigned char *needle = buffer + 5 * page + 123;
+  memcpy(needle, kNeedle, sizeof(kNeedle) - 1);
+
+  report("buffer", (unsigned long)buffer);
+  report("size", size);
+  report("page", page);
+  report("needle", (unsigned long)needle);
+  report("needle_size", sizeof(kNeedle) - 1);
+  report("code", (unsigned long)&unused);
+  report_stop();
+
+  unsigned char *changed = buffer + 9 * page + 42;
+  *changed ^= 0xff;
+  report("changed", (unsigned long)changed);
+
+  unsigned char *regions = mmap(NULL, kRegions * page, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (regions == MAP_FAILED)
+    return 1;
+  for (size_t n = 1; n < kRegions; n += 2)
+    mprotect(regions + n * page, page, PROT_READ);
+  report("regions", (unsigned long)regions);
+  report("region_count", kRegions);
+  report_stop();
+
+  for (;;)
+    pause();
+}
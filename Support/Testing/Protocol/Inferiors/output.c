@@ -0,0 +1,31 @@
+//
+// Copyright (c) 2014-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the University of Illinois/NCSA Open
+// Source License found in the LICENSE file in the root directory of this
+// source tree. An additional grant of patent rights can be found in the
+// PATENTS file in the same directory.
+//
+
+// Writes kLines lines to its standard output and stops.
+
+#include "report.h"
+
+#include <unistd.h>
+
+#define kLines 3
+
+int main(int argc, char **argv) {
+  report_open(argc, argv);
+
+  for (int n = 0; n < kLines; n++) {
+    printf("output line %d\n", n);
+    fflush(stdout);
+  }
+  report("lines", kLines);
+  report_stop();
+
+  for (;;)
+    pause();
+}
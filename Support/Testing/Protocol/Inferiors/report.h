@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2014-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the University of Illinois/NCSA Open
+// Source License found in the LICENSE file in the root directory of this
+// source tree. An additional grant of patent rights can be found in the
+// PATENTS file in the same directory.
+//
+
+#ifndef __Protocol_Inferiors_report_h
+#define __Protocol_Inferiors_report_h
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+//
+// The inferiors tell the tests where things are by appending key=value lines
+// to the file named by their first argument, and then stop themselves with
+// SIGUSR1. Their own output goes through the debugger and may arrive after
+// the stop, so it can't be used for that.
+//
+
+static FILE *gReport;
+
+static void report_open(int argc, char **argv) {
+  if (argc < 2 || (gReport = fopen(argv[1], "a")) == NULL)
+    exit(1);
+}
+
+static void report(char const *key, unsigned long value) {
+  fprintf(gReport, "%s=%lx\n", key, value);
+  fflush(gReport);
+}
+
+static void report_string(char const *key, char const *value) {
+  fprintf(gReport, "%s=%s\n", key, value);
+  fflush(gReport);
+}
+
+static void report_stop(void) { raise(SIGUSR1); }
+
+#endif // !__Protocol_Inferiors_report_h
@@ -0,0 +1,94 @@
+//
+// Copyright (c) 2014-present, Facebook, Inc.
+// All rights reserved.
+//
+// This source code is licensed under the University of Illinois/NCSA Open
+// Source License found in the LICENSE file in the root directory of this
+// source tree. An additional grant of patent rights can be found in the
+// PATENTS file in the same directory.
+//
+
+// Starts as many named threads as its second argument says (kThreads by
+// default) and stops once they all wait. It then renames the first one,
+// starts kMoreThreads more and stops; then lets them all exit and stops
+// again. Finally it starts the first batch of threads again and waits for
+// the debugger to interrupt it.
+
+#define _GNU_SOURCE
+
+#include "report.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#define kThreads 8
+#define kMoreThreads 4
+#define kStackSize (64 * 1024)
+
+static pthread_barrier_t gStarted;
+static pthread_mutex_t gLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gQuit = PTHREAD_COND_INITIALIZER;
+static int gQuitting;
+
+static void *worker(void *arg) {
+  char name[16];
+  snprintf(name, sizeof(name), "worker-%lu", (unsigned long)(uintptr_t)arg);
+  pthread_setname_np(pthread_self(), name);
+  pthread_barrier_wait(&gStarted);
+
+  pthread_mutex_lock(&gLock);
+  while (!gQuitting)
+    pthread_cond_wait(&gQuit, &gLock);
+  pthread_mutex_unlock(&gLock);
+  return NULL;
+}
+
+static void start(pthread_t *threads, size_t first, size_t count) {
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, kStackSize);
+  pthread_barrier_init(&gStarted, NULL, count + 1);
+  for (size_t n = first; n < first + count; n++) {
+    if (pthread_create(&threads[n], &attr, worker, (void *)(uintptr_t)n) != 0)
+      exit(1);
+  }
+  pthread_barrier_wait(&gStarted);
+  pthread_barrier_destroy(&gStarted);
+  pthread_attr_destroy(&attr);
+}
+
+int main(int argc, char **argv) {
+  report_open(argc, argv);
+
+  size_t count = argc > 2 ? strtoul(argv[2], NULL, 0) : kThreads;
+  pthread_t *threads = calloc(count + kMoreThreads, sizeof(pthread_t));
+  if (threads == NULL)
+    return 1;
+
+  report("pid", getpid());
+  start(threads, 0, count);
+  report("threads", count);
+  report_stop();
+
+  pthread_setname_np(threads[0], "renamed");
+  start(threads, count, kMoreThreads);
+  report("threads", count + kMoreThreads);
+  report_stop();
+
+  pthread_mutex_lock(&gLock);
+  gQuitting = 1;
+  pthread_cond_broadcast(&gQuit);
+  pthread_mutex_unlock(&gLock);
+  for (size_t n = 0; n < count + kMoreThreads; n++)
+    pthread_join(threads[n], NULL);
+  report("threads", 0);
+  report_stop();
+
+  gQuitting = 0;
+  start(threads, 0, count);
+  report("threads", count);
+
+  for (;;)
+    pause();
+}
@@ -0,0 +1,158 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+"""Times the thread queries a debugger makes at each stop, and how long
+stopping the inferior takes, with Inferiors/threads.c running thousands of
+threads. See Support/Scripts/run-thread-benchmark.sh."""
+
+import argparse
+import sys
+import time
+
+import gdbremote
+
+# Threads asked about with qThreadStopInfo.
+SAMPLE = 100
+
+
+def median(values):
+    values = sorted(values)
+    middle = len(values) // 2
+    if len(values) % 2:
+        return values[middle]
+    return (values[middle - 1] + values[middle]) / 2.0
+
+
+class Benchmark(object):
+    def __init__(self, threads):
+        self.threads = threads
+        self.server = gdbremote.Server(gdbremote.inferior('threads'),
+                                       [str(threads)])
+        self.client = gdbremote.Client(self.server.port)
+        self.client.start_no_ack_mode()
+        self.check(self.client.request('QListThreadsInStopReply') == b'OK')
+
+    def close(self):
+        self.client.close()
+        self.server.close()
+
+    def check(self, condition, message='unexpected reply'):
+        if not condition:
+            raise AssertionError(message)
+
+    def reported(self):
+        values = {}
+        with open(self.server.report) as f:
+            for line in f.read().splitlines():
+                key, _, value = line.partition('=')
+                values[key] = int(value, 16)
+        return values
+
+    def stop_reply(self):
+        reply = self.client.receive()
+        while reply[:1] == b'O' and reply != b'OK':
+            reply = self.client.receive()
+        self.check(reply[:1] == b'T', reply)
+        return gdbremote.StopReply(reply)
+
+    def run_to_stop(self):
+        self.client.send('c')
+        return self.stop_reply()
+
+    def thread_list(self):
+        tids = []
+        reply = self.client.request('qfThreadInfo')
+        while reply != b'l':
+            tids.extend(int(tid, 16) for tid in reply[1:].split(b','))
+            reply = self.client.request('qsThreadInfo')
+        return tids
+
+    def thread_stop_info(self, tid):
+        reply = self.client.request('qThreadStopInfo%x' % tid)
+        self.check(reply[:1] == b'T', reply)
+
+    def continue_running(self):
+        """ds2 drops the packets still queued when an interrupt comes in, so
+        wait for the main thread to leave its traced stop."""
+        self.client.send('c')
+        stat = '/proc/%d/stat' % self.reported()['pid']
+        deadline = time.time() + gdbremote.TIMEOUT
+        while True:
+            with open(stat) as f:
+                if f.read().rpartition(')')[2].split()[0] != 't':
+                    return
+            self.check(time.time() < deadline, 'inferior did not resume')
+            time.sleep(0.01)
+
+    def wait_for_threads(self):
+        deadline = time.time() + gdbremote.TIMEOUT
+        while self.reported()['threads'] != self.threads:
+            self.check(time.time() < deadline, 'threads did not start')
+            time.sleep(0.01)
+
+    def run(self, repeat):
+        timings = {}
+
+        def measure(name, function, *arguments):
+            start = time.time()
+            result = function(*arguments)
+            timings.setdefault(name, []).append(time.time() - start)
+            return result
+
+        stop = measure('run to first stop', self.run_to_stop)
+        self.check(len(stop.pairs['threads'].split(',')) == self.threads + 1,
+                   'missing threads in the stop reply')
+        for _ in range(repeat):
+            tids = measure('qfThreadInfo/qsThreadInfo', self.thread_list)
+            self.check(len(tids) == self.threads + 1)
+            measure('jThreadsInfo', self.client.request, 'jThreadsInfo')
+            # A sample, asking about every thread would take too long.
+            for tid in tids[::max(1, len(tids) // SAMPLE)]:
+                measure('qThreadStopInfo (one thread)',
+                        self.thread_stop_info, tid)
+            measure('? (stop reply)', self.client.request, '?')
+
+        # Get to the last stage, where the threads run until interrupted.
+        for _ in range(2):
+            self.run_to_stop()
+        self.client.send('c')
+        self.wait_for_threads()
+        for _ in range(repeat):
+            self.client.interrupt()
+            measure('interrupt to stop reply', self.stop_reply)
+            self.continue_running()
+
+        return timings
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--threads', type=int, nargs='+',
+                        default=[1000, 10000],
+                        help='thread counts to measure (default: 1000 10000)')
+    parser.add_argument('--repeat', type=int, default=5,
+                        help='measurements of each query (default: 5)')
+    options = parser.parse_args()
+
+    for threads in options.threads:
+        benchmark = Benchmark(threads)
+        try:
+            timings = benchmark.run(options.repeat)
+        finally:
+            benchmark.close()
+
+        print('%d threads (medians):' % threads)
+        for name in sorted(timings):
+            print('  %-32s %10.2f ms' % (name, median(timings[name]) * 1000))
+        sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,380 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+# Just enough of the GDB remote protocol to drive ds2 packet by packet. The
+# tests run ds2 from $DS2 (./ds2 by default) on the programs built from
+# Inferiors/ into $DS2_TEST_INFERIORS, see Support/Scripts/run-protocol-tests.sh.
+
+import binascii
+import json
+import os
+import select
+import shutil
+import signal
+import socket
+import subprocess
+import tempfile
+import time
+import unittest
+
+TIMEOUT = 30
+
+
+def checksum(data):
+    return sum(bytearray(data)) & 0xff
+
+
+def to_bytes(data):
+    return data.encode('ascii') if isinstance(data, str) else data
+
+
+def encode_hex(data):
+    return binascii.hexlify(to_bytes(data))
+
+
+def decode_hex(data):
+    return binascii.unhexlify(data)
+
+
+def escape(data):
+    out = bytearray()
+    for byte in bytearray(data):
+        if byte in b'#$}*':
+            out += bytearray([0x7d, byte ^ 0x20])
+        else:
+            out.append(byte)
+    return bytes(out)
+
+
+def unescape(data):
+    out = bytearray()
+    data = bytearray(data)
+    n = 0
+    while n < len(data):
+        if data[n] == 0x7d:
+            n += 1
+            out.append(data[n] ^ 0x20)
+        else:
+            out.append(data[n])
+        n += 1
+    return bytes(out)
+
+
+def decode_integer(data):
+    """Registers and memory come in target order, little endian here."""
+    return int.from_bytes(decode_hex(data), 'little')
+
+
+def parse_pairs(data):
+    """Splits 'key:value;key:value;' replies into a dict of strings."""
+    pairs = {}
+    for item in data.decode('ascii').split(';'):
+        if item:
+            key, _, value = item.partition(':')
+            pairs[key] = value
+    return pairs
+
+
+class StopReply(object):
+    """A stop reply: signal, thread, expedited memory and the other
+    key:value pairs."""
+
+    def __init__(self, data):
+        self.data = data
+        self.kind = data[:1]
+        self.pairs = {}
+        self.memory = {}
+        if self.kind == b'T':
+            self.signal = int(data[1:3], 16)
+            # memory can appear several times, with an address=bytes value.
+            for item in data[3:].decode('ascii').split(';'):
+                key, _, value = item.partition(':')
+                if key == 'memory':
+                    address, _, value = value.partition('=')
+                    self.memory[int(address, 16)] = decode_hex(value)
+                elif key:
+                    self.pairs[key] = value
+        else:
+            self.signal = int(data[1:3], 16) if len(data) >= 3 else None
+
+    def registers(self):
+        """Expedited registers, indexed by register number."""
+        return dict((int(key, 16), value) for key, value in self.pairs.items()
+                    if len(key) == 2 and all(c in '0123456789abcdef'
+                                              for c in key))
+
+    def thread(self):
+        value = self.pairs.get('thread')
+        if value is None:
+            return None
+        return int(value.split('.')[-1].lstrip('p'), 16)
+
+
+class Client(object):
+    def __init__(self, port):
+        deadline = time.time() + TIMEOUT
+        while True:
+            try:
+                self.socket = socket.create_connection(('localhost', port))
+                break
+            except socket.error:
+                if time.time() > deadline:
+                    raise
+                time.sleep(0.05)
+        self.socket.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.buffer = b''
+        self.notifications = []
+        self.acks = True
+
+    def close(self):
+        self.socket.close()
+
+    def send(self, packet):
+        packet = to_bytes(packet)
+        self.socket.sendall(b'$' + packet + b'#' +
+                           ('%02x' % checksum(packet)).encode('ascii'))
+
+    def interrupt(self):
+        self.socket.sendall(b'\x03')
+
+    def _read(self):
+        ready, _, _ = select.select([self.socket], [], [], TIMEOUT)
+        if not ready:
+            raise AssertionError('timed out waiting for ds2')
+        data = self.socket.recv(1 << 20)
+        if not data:
+            raise EOFError('ds2 closed the connection')
+        self.buffer += data
+
+    def _next(self):
+        """Returns the next packet or notification, with its start char."""
+        while True:
+            self.buffer = self.buffer.lstrip(b'+-')
+            start = self.buffer[:1]
+            end = self.buffer.find(b'#')
+            if (start in (b'$', b'%') and end >= 0 and
+                    len(self.buffer) >= end + 3):
+                payload = self.buffer[1:end]
+                expected = int(self.buffer[end + 1:end + 3], 16)
+                self.buffer = self.buffer[end + 3:]
+                if checksum(payload) != expected:
+                    raise AssertionError('bad checksum on %r' % payload)
+                if start == b'$' and self.acks:
+                    self.socket.sendall(b'+')
+                return start, payload
+            self._read()
+
+    def receive(self):
+        """Returns the next packet; notifications are queued meanwhile."""
+        while True:
+            start, payload = self._next()
+            if start == b'$':
+                return payload
+            self.notifications.append(payload)
+
+    def notification(self):
+        if self.notifications:
+            return self.notifications.pop(0)
+        while True:
+            start, payload = self._next()
+            if start == b'%':
+                return payload
+            raise AssertionError('unexpected packet %r' % payload)
+
+    def request(self, packet):
+        self.send(packet)
+        return self.receive()
+
+    def start_no_ack_mode(self):
+        reply = self.request('QStartNoAckMode')
+        if reply != b'OK':
+            raise AssertionError('QStartNoAckMode failed: %r' % reply)
+        self.acks = False
+
+
+class Server(object):
+    """ds2 debugging a program, listening on a port it picked itself. The
+    program gets the path of its report file as first argument."""
+
+    def __init__(self, program, arguments=(), gdb=False):
+        self.directory = tempfile.mkdtemp(prefix='ds2-test-')
+        self.report = os.path.join(self.directory, 'report')
+        fifo = os.path.join(self.directory, 'port')
+        os.mkfifo(fifo)
+
+        command = [os.environ.get('DS2', os.path.abspath('ds2')), 'g', '-N',
+                   fifo]
+        if gdb:
+            command.append('-g')
+        command += ['--', program, self.report] + list(arguments)
+
+        self.stdout = open(os.path.join(self.directory, 'stdout'), 'wb')
+        self.stderr = open(os.path.join(self.directory, 'stderr'), 'wb')
+        self.process = subprocess.Popen(command, stdout=self.stdout,
+                                        stderr=self.stderr)
+        self.port = self._read_port(fifo)
+
+    def _read_port(self, fifo):
+        fd = os.open(fifo, os.O_RDONLY | os.O_NONBLOCK)
+        try:
+            data = b''
+            deadline = time.time() + TIMEOUT
+            while not data.endswith(b'\0'):
+                if self.process.poll() is not None:
+                    raise AssertionError('ds2 exited with status %d' %
+                                         self.process.returncode)
+                if time.time() > deadline:
+                    raise AssertionError('ds2 did not report its port')
+                select.select([fd], [], [], 0.1)
+                data += os.read(fd, 64)
+            return int(data[:-1])
+        finally:
+            os.close(fd)
+
+    def output(self):
+        """What ds2 printed on its own stdout."""
+        self.stdout.flush()
+        with open(self.stdout.name, 'rb') as f:
+            return f.read()
+
+    def _inferiors(self):
+        """The processes ds2 started; they call setsid, so they can't be
+        killed as a process group."""
+        pids = []
+        task = '/proc/%d/task' % self.process.pid
+        for tid in os.listdir(task) if os.path.isdir(task) else ():
+            try:
+                with open(os.path.join(task, tid, 'children')) as f:
+                    pids += [int(pid) for pid in f.read().split()]
+            except (IOError, OSError):
+                pass
+        return pids
+
+    def close(self):
+        if self.process.poll() is None:
+            # Killing ds2 alone leaves the inferior running, possibly stopped.
+            for pid in self._inferiors():
+                try:
+                    os.kill(pid, signal.SIGKILL)
+                except OSError:
+                    pass
+            self.process.kill()
+        self.process.wait()
+        self.stdout.close()
+        self.stderr.close()
+        shutil.rmtree(self.directory, ignore_errors=True)
+
+
+def inferior(name):
+    directory = os.environ.get('DS2_TEST_INFERIORS', os.path.abspath('.'))
+    return os.path.join(directory, name)
+
+
+class TestCase(unittest.TestCase):
+    """Starts ds2 on `program` for each test, in LLDB mode by default.
+
+    The inferiors report what the tests need to know and then stop
+    themselves with SIGUSR1, see Inferiors/report.h.
+    """
+
+    program = None
+    arguments = ()
+    gdb = False
+
+    def setUp(self):
+        self.server = Server(inferior(self.program), self.arguments, self.gdb)
+        self.addCleanup(self.server.close)
+        self.client = Client(self.server.port)
+        self.addCleanup(self.client.close)
+        # Acknowledgments make every request wait for a delayed TCP ACK.
+        self.client.start_no_ack_mode()
+
+    def request(self, packet):
+        return self.client.request(packet)
+
+    def request_json(self, packet):
+        """Decodes a JSON reply, which is escaped like binary data."""
+        reply = self.request(packet)
+        self.assertNotEqual(reply[:1], b'E', reply)
+        return json.loads(unescape(reply).decode())
+
+    def assertOK(self, reply):
+        self.assertEqual(reply, b'OK')
+
+    def resume(self, packet='c'):
+        """Resumes with `packet` and returns the stop reply along with the
+        output of the inferior until then."""
+        self.client.send(packet)
+        output = b''
+        while True:
+            reply = self.client.receive()
+            if reply[:1] == b'O' and reply != b'OK':
+                output += decode_hex(reply[1:])
+                continue
+            return StopReply(reply), output
+
+    def run_to_stop(self):
+        """Continues to the next SIGUSR1 the inferior raises and returns
+        what it reported so far, as integers when the values are hex."""
+        stop, _ = self.resume()
+        self.assertEqual(stop.signal, signal.SIGUSR1, stop.data)
+        return self.reported()
+
+    def reported(self):
+        values = {}
+        with open(self.server.report) as f:
+            for line in f.read().splitlines():
+                key, _, value = line.partition('=')
+                try:
+                    values[key] = int(value, 16)
+                except ValueError:
+                    values[key] = value
+        return values
+
+    def read_memory(self, address, length, chunk=0x1000):
+        data = b''
+        while len(data) < length:
+            size = min(chunk, length - len(data))
+            reply = self.request('m%x,%x' % (address + len(data), size))
+            self.assertNotEqual(reply[:1], b'E', reply)
+            data += decode_hex(reply)
+        return data
+
+    def write_memory(self, address, data):
+        self.assertOK(self.request('M%x,%x:%s' % (address, len(data),
+                                                  encode_hex(data).decode())))
+
+    def xfer_read(self, object, annex, chunk=0x3000):
+        """The whole qXfer `object` document named `annex`, read `chunk`
+        bytes at a time."""
+        data = b''
+        while True:
+            reply = self.request(('qXfer:%s:read:%s:%x,%x' % (
+                object, annex, len(data), chunk)).encode())
+            self.assertIn(reply[:1], (b'l', b'm'), reply)
+            data += unescape(reply[1:])
+            if reply[:1] == b'l':
+                return data
+
+    def generic_register(self, name):
+        """The number of the register qRegisterInfo calls generic:`name`."""
+        for regno, info in enumerate(self.register_info()):
+            if info.get('generic') == name:
+                return regno
+        self.fail('no %s register' % name)
+
+    def register_info(self):
+        """qRegisterInfo for every register, in register number order."""
+        registers = []
+        while True:
+            reply = self.request('qRegisterInfo%x' % len(registers))
+            if reply[:1] == b'E':
+                return registers
+            registers.append(parse_pairs(reply))
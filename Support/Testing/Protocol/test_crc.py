@@ -0,0 +1,63 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import gdbremote
+
+
+def crc32(data):
+    """The CRC-32 GDB uses: MSB first, no reflection and no final xor."""
+    crc = 0xffffffff
+    for byte in bytearray(data):
+        crc ^= byte << 24
+        for _ in range(8):
+            if crc & 0x80000000:
+                crc = ((crc << 1) ^ 0x04c11db7) & 0xffffffff
+            else:
+                crc = (crc << 1) & 0xffffffff
+    return crc
+
+
+class CRCTest(gdbremote.TestCase):
+    program = 'memory'
+
+    def setUp(self):
+        super(CRCTest, self).setUp()
+        self.values = self.run_to_stop()
+        self.buffer = self.values['buffer']
+
+    def crc(self, address, length):
+        reply = self.request('qCRC:%x,%x' % (address, length))
+        self.assertEqual(reply[:1], b'C', reply)
+        self.assertEqual(len(reply), 9, reply)
+        return int(reply[1:], 16)
+
+    def assertCRC(self, address, length):
+        self.assertEqual(self.crc(address, length),
+                         crc32(self.read_memory(address, length)))
+
+    def test_buffer(self):
+        self.assertCRC(self.buffer, self.values['size'])
+
+    def test_unaligned(self):
+        # Lengths that aren't multiples of the 8 bytes folded at once.
+        for offset, length in [(1, 1), (3, 7), (5, 13), (4093, 9)]:
+            self.assertCRC(self.buffer + offset, length)
+
+    def test_empty(self):
+        self.assertEqual(self.crc(self.buffer, 0), 0xffffffff)
+
+    def test_write(self):
+        before = self.crc(self.buffer, 0x100)
+        self.write_memory(self.buffer + 0x80, b'\x00')
+        self.assertNotEqual(self.crc(self.buffer, 0x100), before)
+        self.assertCRC(self.buffer, 0x100)
+
+    def test_unmapped(self):
+        self.assertEqual(self.request('qCRC:0,10')[:1], b'E')
@@ -0,0 +1,62 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import gdbremote
+
+
+class DirtyPagesTest(gdbremote.TestCase):
+    program = 'memory'
+
+    def setUp(self):
+        super(DirtyPagesTest, self).setUp()
+        self.values = self.run_to_stop()
+        self.buffer = self.values['buffer']
+        self.page = self.values['page']
+
+    def enable_tracking(self):
+        if self.request('QDirtyPageTracking:1') != b'OK':
+            self.skipTest('soft-dirty page tracking is not available')
+
+    def dirty_pages(self, address, count):
+        """Whether each of the `count` pages from `address` is dirty."""
+        reply = self.request('qDirtyPages:%x,%x' % (address,
+                                                    count * self.page))
+        self.assertNotEqual(reply[:1], b'E', reply)
+        page_size, _, bitmap = reply.partition(b';')
+        self.assertEqual(int(page_size, 16), self.page)
+        bitmap = bytearray(gdbremote.decode_hex(bitmap))
+        return [bool(bitmap[n // 8] & (1 << (n % 8))) for n in range(count)]
+
+    def test_disabled(self):
+        self.assertEqual(self.request('qDirtyPages:%x,%x' %
+                                      (self.buffer, self.page))[:1], b'E')
+
+    def test_written(self):
+        # Only the page holding the changed byte is written between the
+        # stops.
+        self.enable_tracking()
+        self.run_to_stop()
+        self.assertEqual(self.dirty_pages(self.buffer, 16),
+                         [n == 9 for n in range(16)])
+
+    def test_breakpoint(self):
+        # Inserting breakpoints writes to their page at each resume.
+        self.enable_tracking()
+        code = self.values['code']
+        self.assertOK(self.request('Z0,%x,1' % code))
+        self.run_to_stop()
+        self.assertEqual(self.dirty_pages(code, 1), [True])
+        self.assertOK(self.request('z0,%x,1' % code))
+
+    def test_turned_off(self):
+        self.enable_tracking()
+        self.assertOK(self.request('QDirtyPageTracking:0'))
+        self.assertEqual(self.request('qDirtyPages:%x,%x' %
+                                      (self.buffer, self.page))[:1], b'E')
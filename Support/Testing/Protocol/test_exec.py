@@ -0,0 +1,98 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import signal
+import struct
+
+import gdbremote
+
+AT_ENTRY = 9
+
+
+def read_elf(path):
+    """The entry point of the ELF64 file at `path` and a function reading
+    `length` bytes at a virtual address from its loadable segments."""
+    with open(path, 'rb') as f:
+        image = f.read()
+    entry, phoff = struct.unpack_from('<QQ', image, 24)
+    phentsize, phnum = struct.unpack_from('<HH', image, 54)
+    segments = []
+    for n in range(phnum):
+        kind, _, offset, vaddr, _, filesz = struct.unpack_from(
+            '<IIQQQQ', image, phoff + n * phentsize)
+        if kind == 1:
+            segments.append((vaddr, offset, filesz))
+
+    def read(address, length):
+        for vaddr, offset, filesz in segments:
+            if vaddr <= address and address + length <= vaddr + filesz:
+                start = offset + address - vaddr
+                return image[start:start + length]
+        return None
+
+    return entry, read
+
+
+class ExecTest(gdbremote.TestCase):
+    program = 'exec'
+
+    def setUp(self):
+        super(ExecTest, self).setUp()
+        self.values = self.run_to_stop()
+
+    def entry(self):
+        auxv = self.xfer_read('auxv', '')
+        for n in range(0, len(auxv), 16):
+            key, value = struct.unpack_from('<QQ', auxv, n)
+            if key == AT_ENTRY:
+                return value
+        self.fail('no AT_ENTRY')
+
+    def run_through_exec(self):
+        stop, _ = self.resume()
+        self.assertEqual(stop.signal, signal.SIGTRAP, stop.data)
+        return self.run_to_stop()
+
+    def test_auxiliary_vector(self):
+        entry, _ = read_elf(gdbremote.inferior('exec'))
+        self.assertEqual(self.entry(), entry)
+        self.run_through_exec()
+        entry, _ = read_elf(gdbremote.inferior('memory'))
+        self.assertEqual(self.entry(), entry)
+
+    def test_memory(self):
+        # Code read before the exec doesn't outlive it.
+        before, _ = read_elf(gdbremote.inferior('exec'))
+        after, read = read_elf(gdbremote.inferior('memory'))
+        self.read_memory(before, 0x40)
+        self.read_memory(after, 0x40)
+        self.run_through_exec()
+        self.assertEqual(self.read_memory(after, 0x40), read(after, 0x40))
+        if read(before, 0x40) is not None:
+            self.assertEqual(self.read_memory(before, 0x40),
+                             read(before, 0x40))
+
+    def test_static_queries(self):
+        # Answers are served again, unchanged, and still right after the
+        # exec: same process, same architecture.
+        process = self.request('qProcessInfo')
+        host = self.request('qHostInfo')
+        registers = [self.request('qRegisterInfo%x' % n) for n in range(4)]
+        features = self.xfer_read('features', 'target.xml')
+        self.assertEqual(self.request('qProcessInfo'), process)
+        self.assertEqual(self.request('qHostInfo'), host)
+        self.run_through_exec()
+        self.assertEqual(self.request('qProcessInfo'), process)
+        self.assertEqual(self.request('qHostInfo'), host)
+        self.assertEqual([self.request('qRegisterInfo%x' % n)
+                          for n in range(4)], registers)
+        self.assertEqual(self.xfer_read('features', 'target.xml'), features)
+        pid = gdbremote.parse_pairs(process)['pid']
+        self.assertEqual(int(pid, 16), self.values['pid'])
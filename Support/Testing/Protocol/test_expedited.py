@@ -0,0 +1,42 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import gdbremote
+
+
+class ExpeditedMemoryTest(gdbremote.TestCase):
+    program = 'memory'
+
+    def expedited_memory(self, features=None):
+        if features is not None:
+            self.request('qSupported:' + features)
+        stop, _ = self.resume()
+        pc = self.generic_register('pc')
+        return gdbremote.decode_integer(stop.pairs['%02x' % pc]), stop.memory
+
+    def assertMatchesTarget(self, memory):
+        for address, data in memory.items():
+            self.assertEqual(self.read_memory(address, len(data)), data)
+
+    def test_default(self):
+        pc, memory = self.expedited_memory()
+        self.assertEqual(len(memory[pc]), 0x40)
+        self.assertMatchesTarget(memory)
+
+    def test_size(self):
+        pc, memory = self.expedited_memory('ExpeditedMemory=80')
+        self.assertEqual(len(memory[pc]), 0x80)
+        self.assertMatchesTarget(memory)
+
+    def test_disabled(self):
+        reply = self.request('qSupported:ExpeditedMemory-')
+        self.assertNotIn(b'ExpeditedMemory', reply)
+        stop, _ = self.resume()
+        self.assertEqual(stop.memory, {})
@@ -0,0 +1,68 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import gdbremote
+
+
+class ExpeditedRegistersTest(gdbremote.TestCase):
+    program = 'memory'
+
+    def setUp(self):
+        super(ExpeditedRegistersTest, self).setUp()
+        self.registers = self.register_info()
+
+    def expedited(self, feature=None):
+        """The numbers of the registers in the stop reply once `feature` is
+        negotiated, after checking their values."""
+        if feature is not None:
+            self.request('qSupported:' + feature)
+        stop, _ = self.resume()
+        numbers = set()
+        for regno, value in stop.registers().items():
+            reply = self.request('p%x' % regno)
+            self.assertEqual(gdbremote.to_bytes(value), reply,
+                             self.registers[regno]['name'])
+            numbers.add(regno)
+        return numbers
+
+    def general_purpose(self):
+        return set(regno for regno, info in enumerate(self.registers)
+                   if info.get('set') == 'General Purpose Registers' and
+                   'container-regs' not in info)
+
+    def generic(self, names=('pc', 'sp', 'fp', 'ra')):
+        return set(regno for regno, info in enumerate(self.registers)
+                   if info.get('generic') in names)
+
+    def test_default(self):
+        self.assertEqual(self.expedited(), self.general_purpose())
+
+    def test_all(self):
+        self.assertEqual(self.expedited('ExpeditedRegisters=all'),
+                         self.general_purpose())
+
+    def test_generic(self):
+        numbers = self.expedited('ExpeditedRegisters=generic')
+        self.assertEqual(numbers, self.generic())
+        self.assertIn(self.generic_register('pc'), numbers)
+        self.assertIn(self.generic_register('sp'), numbers)
+
+    def test_not_supported(self):
+        self.assertEqual(self.expedited('ExpeditedRegisters-'), self.generic())
+
+    def test_list(self):
+        self.assertEqual(self.expedited('ExpeditedRegisters=0,3,10'),
+                         set([0, 3, 0x10]))
+
+    def test_renegotiate(self):
+        # The set is worked out at the first stop and again when it changes.
+        self.assertEqual(self.expedited('ExpeditedRegisters=10'), set([0x10]))
+        self.assertEqual(self.expedited('ExpeditedRegisters=all'),
+                         self.general_purpose())
@@ -0,0 +1,87 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import os
+import signal
+import time
+
+import gdbremote
+
+
+class InterruptTest(gdbremote.TestCase):
+    program = 'threads'
+
+    def setUp(self):
+        super(InterruptTest, self).setUp()
+        for _ in range(3):
+            self.values = self.run_to_stop()
+        self.running()
+
+    def running(self):
+        """Resumes the inferior and waits until all its threads run."""
+        self.client.send('c')
+        deadline = time.time() + gdbremote.TIMEOUT
+        while self.reported()['threads'] == 0:
+            self.assertLess(time.time(), deadline)
+            time.sleep(0.01)
+        self.values = self.reported()
+
+    def continue_running(self):
+        """Continues and waits until the main thread runs again; ds2 drops
+        the packets still queued when an interrupt comes in."""
+        self.client.send('c')
+        deadline = time.time() + gdbremote.TIMEOUT
+        while self.state(self.values['pid']) == 't':
+            self.assertLess(time.time(), deadline)
+            time.sleep(0.01)
+
+    def state(self, tid):
+        with open('/proc/%d/task/%d/stat' % (self.values['pid'], tid)) as f:
+            return f.read().rpartition(')')[2].split()[0]
+
+    def stop_reply(self):
+        reply = self.client.receive()
+        while reply[:1] == b'O' and reply != b'OK':
+            reply = self.client.receive()
+        return gdbremote.StopReply(reply)
+
+    def assertAllStopped(self):
+        task = '/proc/%d/task' % self.values['pid']
+        tids = os.listdir(task)
+        self.assertEqual(len(tids), self.values['threads'] + 1)
+        for tid in tids:
+            self.assertEqual(self.state(int(tid)), 't', tid)
+
+    def test_interrupt(self):
+        self.client.interrupt()
+        stop = self.stop_reply()
+        self.assertEqual(stop.kind, b'T', stop.data)
+        self.assertAllStopped()
+
+    def test_interrupt_again(self):
+        for _ in range(3):
+            self.client.interrupt()
+            self.stop_reply()
+            self.assertAllStopped()
+            self.continue_running()
+        self.client.interrupt()
+        self.stop_reply()
+        self.assertAllStopped()
+
+    def test_group_stop(self):
+        # A SIGSTOP from elsewhere stops everything too.
+        os.kill(self.values['pid'], signal.SIGSTOP)
+        stop = self.stop_reply()
+        self.assertEqual(stop.signal, signal.SIGSTOP, stop.data)
+        self.assertAllStopped()
+
+
+class InterruptManyThreadsTest(InterruptTest):
+    arguments = ('500',)
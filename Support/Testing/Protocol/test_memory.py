@@ -0,0 +1,98 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import gdbremote
+
+
+def pattern(offset, length):
+    """The bytes Inferiors/memory.c fills its buffer with."""
+    return bytes(bytearray((n * 7 + 3) & 0xff
+                           for n in range(offset, offset + length)))
+
+
+class MemoryTest(gdbremote.TestCase):
+    program = 'memory'
+
+    def setUp(self):
+        super(MemoryTest, self).setUp()
+        self.values = self.run_to_stop()
+        self.buffer = self.values['buffer']
+        self.page = self.values['page']
+
+    def test_read(self):
+        size = self.values['size']
+        data = self.read_memory(self.buffer, size)
+        needle = self.values['needle'] - self.buffer
+        expected = bytearray(pattern(0, size))
+        expected[needle:needle + self.values['needle_size']] = \
+            b'ds2-needle-0123456789'
+        self.assertEqual(data, bytes(expected))
+
+    def test_read_across_pages(self):
+        address = self.buffer + self.page - 5
+        self.assertEqual(self.read_memory(address, 3 * self.page + 10),
+                         pattern(self.page - 5, 3 * self.page + 10))
+
+    def test_binary_read(self):
+        address = self.buffer + 2 * self.page - 100
+        reply = self.request('x%x,%x' % (address, 200))
+        self.assertEqual(gdbremote.unescape(reply),
+                         pattern(2 * self.page - 100, 200))
+
+    def test_write(self):
+        address = self.buffer + 3 * self.page - 8
+        data = bytes(bytearray(range(16)))
+        self.write_memory(address, data)
+        self.assertEqual(self.read_memory(address - 8, 32),
+                         pattern(3 * self.page - 16, 8) + data +
+                         pattern(3 * self.page + 8, 8))
+
+    def test_binary_write(self):
+        address = self.buffer + 4 * self.page
+        # Every byte the protocol needs escaped, and a few that it doesn't.
+        data = b'$#}*\x00\xff$$}}'
+        reply = self.request(('X%x,%x:' % (address, len(data))).encode() +
+                             gdbremote.escape(data))
+        self.assertNotEqual(reply[:1], b'E', reply)
+        self.assertEqual(self.read_memory(address, len(data)), data)
+
+    def test_write_text(self):
+        # Code pages are mapped read-only in the inferior; writes go through
+        # regardless.
+        address = self.values['code']
+        original = self.read_memory(address, 8)
+        data = b'\xcc' * 8
+        self.write_memory(address, data)
+        self.assertEqual(self.read_memory(address, 8), data)
+        self.write_memory(address, original)
+        self.assertEqual(self.read_memory(address, 8), original)
+
+    def test_read_after_write(self):
+        # The first read fills the page cache, the write must update it.
+        address = self.buffer + 7 * self.page + 100
+        self.assertEqual(self.read_memory(address, 16),
+                         pattern(7 * self.page + 100, 16))
+        self.write_memory(address + 4, b'\x00' * 4)
+        self.assertEqual(self.read_memory(address, 16),
+                         pattern(7 * self.page + 100, 4) + b'\x00' * 4 +
+                         pattern(7 * self.page + 108, 8))
+
+    def test_read_after_resume(self):
+        # The inferior changes a byte we have read before running again.
+        offset = 9 * self.page + 42
+        self.assertEqual(self.read_memory(self.buffer + offset, 1),
+                         pattern(offset, 1))
+        values = self.run_to_stop()
+        self.assertEqual(values['changed'], self.buffer + offset)
+        self.assertEqual(self.read_memory(self.buffer + offset, 1),
+                         bytes(bytearray([pattern(offset, 1)[0] ^ 0xff])))
+
+    def test_read_unmapped(self):
+        self.assertEqual(self.request('m0,10')[:1], b'E')
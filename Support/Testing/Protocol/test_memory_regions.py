@@ -0,0 +1,121 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import gdbremote
+
+MAX_PACKET_SIZE = 0x3fff
+
+
+def read_maps(pid):
+    """The regions of /proc/<pid>/maps as (start, size, permissions, name)."""
+    regions = []
+    with open('/proc/%d/maps' % pid) as f:
+        for line in f:
+            fields = line.split(None, 5)
+            start, end = (int(value, 16) for value in fields[0].split('-'))
+            permissions = fields[1][:3].replace('-', '')
+            name = fields[5].strip() if len(fields) > 5 else ''
+            regions.append((start, end - start, permissions, name))
+    return regions
+
+
+def parse_region(data):
+    pairs = gdbremote.parse_pairs(data)
+    return (int(pairs['start'], 16), int(pairs['size'], 16),
+            pairs.get('permissions', ''),
+            gdbremote.decode_hex(pairs.get('name', '')).decode())
+
+
+class MemoryRegionsTest(gdbremote.TestCase):
+    program = 'memory'
+
+    def setUp(self):
+        super(MemoryRegionsTest, self).setUp()
+        self.values = self.run_to_stop()
+        pairs = gdbremote.parse_pairs(self.request('qProcessInfo'))
+        self.pid = int(pairs['pid'], 16)
+
+    def region_info(self, address):
+        reply = self.request('qMemoryRegionInfo:%x' % address)
+        self.assertNotEqual(reply[:1], b'E', reply)
+        return parse_region(reply)
+
+    def regions(self, address=0):
+        """All regions from `address` on with qMemoryRegions, and the number
+        of packets it took."""
+        regions = []
+        packets = 0
+        while True:
+            reply = self.request('qMemoryRegions:%x' % address)
+            self.assertIn(reply[:1], (b'm', b'l'), reply)
+            self.assertLessEqual(len(reply), MAX_PACKET_SIZE)
+            packets += 1
+            regions += [parse_region(region)
+                        for region in reply[1:].split(b'|')]
+            if reply[:1] == b'l':
+                return regions, packets
+            start, size, _, _ = regions[-1]
+            address = start + size
+
+    def expected_regions(self):
+        """The regions and holes of /proc/<pid>/maps, as ds2 reports them."""
+        regions = []
+        end = 0
+        for region in read_maps(self.pid):
+            start, size, _, _ = region
+            if start > end:
+                regions.append((end, start - end, '', ''))
+            regions.append(region)
+            end = start + size
+        return regions
+
+    def assertMatchesMaps(self):
+        end = 0
+        for region in read_maps(self.pid):
+            start, size, _, _ = region
+            if start > end:
+                self.assertEqual(self.region_info(end), (end, start - end,
+                                                         '', ''))
+            self.assertEqual(self.region_info(start), region)
+            self.assertEqual(self.region_info(start + size - 1), region)
+            end = start + size
+
+    def test_regions(self):
+        self.assertMatchesMaps()
+
+    def test_regions_after_resume(self):
+        # The inferior maps new regions before stopping again.
+        self.assertMatchesMaps()
+        values = self.run_to_stop()
+        page = self.values['page']
+        self.assertEqual(self.region_info(values['regions'] + page)[:3],
+                         (values['regions'] + page, page, 'r'))
+        self.assertMatchesMaps()
+
+    def test_bulk_regions(self):
+        regions, _ = self.regions()
+        expected = self.expected_regions()
+        # The hole at the top of the address space comes last.
+        self.assertEqual(regions[:len(expected)], expected)
+        self.assertLessEqual(len(regions), len(expected) + 1)
+
+    def test_bulk_regions_from_address(self):
+        expected = self.expected_regions()
+        start, size, _, _ = expected[-2]
+        regions, _ = self.regions(start + size // 2)
+        self.assertEqual(regions[:2], expected[-2:])
+
+    def test_bulk_regions_continuation(self):
+        values = self.run_to_stop()
+        regions, packets = self.regions()
+        self.assertGreater(packets, 1)
+        expected = self.expected_regions()
+        self.assertGreater(len(expected), values['region_count'])
+        self.assertEqual(regions[:len(expected)], expected)
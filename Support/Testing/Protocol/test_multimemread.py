@@ -0,0 +1,78 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import gdbremote
+
+MAX_PACKET_SIZE = 0x3fff
+
+
+class MultiMemReadTest(gdbremote.TestCase):
+    program = 'memory'
+
+    def setUp(self):
+        super(MultiMemReadTest, self).setUp()
+        self.values = self.run_to_stop()
+        self.buffer = self.values['buffer']
+        self.page = self.values['page']
+
+    def multi_read(self, ranges):
+        reply = self.request('MultiMemRead:ranges:%s;' % ','.join(
+            '%x,%x' % (address, length) for address, length in ranges))
+        self.assertNotEqual(reply[:1], b'E', reply)
+        lengths, _, data = reply.partition(b';')
+        data = gdbremote.unescape(data)
+        blocks = []
+        for length in lengths.split(b','):
+            blocks.append(data[:int(length, 16)])
+            data = data[int(length, 16):]
+        self.assertEqual(data, b'')
+        return blocks
+
+    def test_ranges(self):
+        ranges = [(self.buffer + 0x10, 0x20),
+                  (self.buffer + 3 * self.page - 0x100, 0x200),
+                  (self.values['needle'], self.values['needle_size']),
+                  (self.buffer, 1)]
+        blocks = self.multi_read(ranges)
+        self.assertEqual(len(blocks), len(ranges))
+        for (address, length), block in zip(ranges, blocks):
+            self.assertEqual(block, self.read_memory(address, length))
+
+    def test_unreadable(self):
+        blocks = self.multi_read([(self.buffer, 8), (0, 8), (self.buffer, 0)])
+        self.assertEqual(blocks, [self.read_memory(self.buffer, 8), b'', b''])
+
+    def test_after_write(self):
+        self.write_memory(self.buffer + 0x40, b'}#$*')
+        self.assertEqual(self.multi_read([(self.buffer + 0x3e, 8)]),
+                         [self.read_memory(self.buffer + 0x3e, 8)])
+
+    def test_large(self):
+        ranges = [(self.buffer + n * self.page, 0x1000) for n in range(3)]
+        self.assertEqual(self.multi_read(ranges),
+                         [self.read_memory(address, length)
+                          for address, length in ranges])
+
+    def test_too_large(self):
+        # Requests whose reply can't fit in a packet are rejected rather
+        # than truncated.
+        self.assertEqual(self.request('MultiMemRead:ranges:%x,%x;' %
+                                      (self.buffer, MAX_PACKET_SIZE + 1))[:1],
+                         b'E')
+        ranges = ','.join('%x,%x' % (self.buffer, 0x1000) for _ in range(4))
+        self.assertEqual(self.request('MultiMemRead:ranges:%s;' % ranges)[:1],
+                         b'E')
+
+    def test_malformed(self):
+        self.assertEqual(self.request('MultiMemRead:ranges:;')[:1], b'E')
+        self.assertEqual(self.request('MultiMemRead:%x,8;' % self.buffer)[:1],
+                         b'E')
+        self.assertEqual(self.request('MultiMemRead:ranges:%x;' %
+                                      self.buffer)[:1], b'E')
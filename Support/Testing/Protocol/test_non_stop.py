@@ -0,0 +1,140 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import os
+import signal
+
+import gdbremote
+
+
+class NonStopTestCase(gdbremote.TestCase):
+    gdb = True
+
+    def setUp(self):
+        super(NonStopTestCase, self).setUp()
+        # Like GDB, ask for multiprocess stop replies, which name the thread.
+        reply = self.request('qSupported:multiprocess+')
+        self.assertIn(b'QNonStop+', reply.split(b';'))
+        self.assertOK(self.request('QNonStop:1'))
+
+    def notification(self, name):
+        """The payload of the next `name` notification."""
+        notification = self.client.notification()
+        kind, _, payload = notification.partition(b':')
+        self.assertEqual(kind, name.encode(), notification)
+        return payload
+
+    def stops(self):
+        """The stop that was just notified and the queued ones."""
+        stops = [gdbremote.StopReply(self.notification('Stop'))]
+        reply = self.request('vStopped')
+        while reply != b'OK':
+            stops.append(gdbremote.StopReply(reply))
+            reply = self.request('vStopped')
+        return stops
+
+
+class NonStopTest(NonStopTestCase):
+    program = 'threads'
+
+    def state(self, tid):
+        with open('/proc/%d/task/%d/stat' % (self.pid, tid)) as f:
+            return f.read().rpartition(')')[2].split()[0]
+
+    def run_to_stop(self):
+        # Only the thread that raised SIGUSR1 stops.
+        self.assertOK(self.request('vCont;c'))
+        stops = self.stops()
+        self.assertEqual(len(stops), 1)
+        self.assertEqual(stops[0].signal, signal.SIGUSR1, stops[0].data)
+        values = self.reported()
+        self.pid = values['pid']
+        self.assertEqual(stops[0].thread(), self.pid)
+        return values
+
+    def workers(self):
+        return [int(tid) for tid in os.listdir('/proc/%d/task' % self.pid)
+                if int(tid) != self.pid]
+
+    def test_initial_stops(self):
+        # '?' starts over with every stopped thread.
+        reply = self.request('?')
+        self.assertEqual(reply[:1], b'T', reply)
+        self.assertOK(self.request('vStopped'))
+
+    def test_others_keep_running(self):
+        values = self.run_to_stop()
+        workers = self.workers()
+        self.assertEqual(len(workers), values['threads'])
+        self.assertEqual(self.state(self.pid), 't')
+        for tid in workers:
+            self.assertNotEqual(self.state(tid), 't', tid)
+
+    def test_stop_thread(self):
+        self.run_to_stop()
+        worker = self.workers()[0]
+        self.assertOK(self.request('vCont;t:p%x.%x' % (self.pid, worker)))
+        stops = self.stops()
+        self.assertEqual([stop.thread() for stop in stops], [worker])
+        self.assertEqual(stops[0].signal, 0, stops[0].data)
+        self.assertEqual(self.state(worker), 't')
+        for tid in self.workers()[1:]:
+            self.assertNotEqual(self.state(tid), 't', tid)
+
+    def test_registers_while_running(self):
+        self.run_to_stop()
+        pc = self.generic_register('pc')
+        self.assertOK(self.request('Hgp%x.%x' % (self.pid, self.pid)))
+        original = self.request('p%x' % pc)
+        self.assertOK(self.request('P%x=%s' % (pc, original.decode())))
+        self.assertEqual(self.request('p%x' % pc), original)
+        # The stopped thread resumes on its own and stops again.
+        values = self.run_to_stop()
+        self.assertEqual(len(self.workers()), values['threads'])
+
+    def test_breakpoint_while_running(self):
+        # Inserted while the workers run, and invisible to memory reads.
+        self.run_to_stop()
+        pc = self.generic_register('pc')
+        self.assertOK(self.request('Hgp%x.%x' % (self.pid, self.pid)))
+        address = gdbremote.decode_integer(self.request('p%x' % pc))
+        original = self.request('m%x,8' % address)
+        self.assertOK(self.request('Z0,%x,1' % address))
+        self.assertEqual(self.request('m%x,8' % address), original)
+        self.assertOK(self.request('z0,%x,1' % address))
+        self.assertEqual(self.request('m%x,8' % address), original)
+
+
+class NonStopOutputTest(NonStopTestCase):
+    program = 'output'
+
+    def test_output(self):
+        # The output comes as %Stdio notifications, not on ds2's stdout.
+        self.assertOK(self.request('vCont;c'))
+        output = b''
+        stops = []
+        while not stops or output.count(b'\n') < 3:
+            notification = self.client.notification()
+            kind, _, payload = notification.partition(b':')
+            if kind == b'Stdio':
+                while payload != b'OK':
+                    self.assertEqual(payload[:1], b'O', payload)
+                    output += gdbremote.decode_hex(payload[1:])
+                    payload = self.request('vStdio')
+            else:
+                self.assertEqual(kind, b'Stop', notification)
+                stops.append(gdbremote.StopReply(payload))
+                self.assertOK(self.request('vStopped'))
+        # The inferior writes to a terminal.
+        self.assertEqual(output.replace(b'\r\n', b'\n'),
+                         ''.join('output line %d\n' % n
+                                 for n in range(3)).encode())
+        self.assertEqual(stops[0].signal, signal.SIGUSR1)
+        self.assertNotIn(b'output line', self.server.output())
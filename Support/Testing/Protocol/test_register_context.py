@@ -0,0 +1,85 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import signal
+
+import gdbremote
+
+
+class RegisterContextTest(gdbremote.TestCase):
+    program = 'memory'
+    binary = False
+
+    def setUp(self):
+        super(RegisterContextTest, self).setUp()
+        reply = self.request('qSupported:BinaryRegisters%s' %
+                             ('+' if self.binary else '-'))
+        # ds2 offers it either way, it is used only if we asked for it.
+        self.assertIn(b'BinaryRegisters+', reply.split(b';'))
+        self.run_to_stop()
+        self.registers = self.register_info()
+
+    def read_context(self):
+        reply = self.request('g')
+        self.assertNotEqual(reply[:1], b'E', reply)
+        if self.binary:
+            return gdbremote.unescape(reply)
+        return gdbremote.decode_hex(reply)
+
+    def write_context(self, context):
+        if self.binary:
+            data = gdbremote.escape(context)
+        else:
+            data = gdbremote.encode_hex(context)
+        self.assertOK(self.request(b'G' + data))
+
+    def slice(self, regno):
+        info = self.registers[regno]
+        offset = int(info['offset'])
+        return slice(offset, offset + int(info['bitsize']) // 8)
+
+    def test_layout(self):
+        # The context covers every register at its qRegisterInfo offset.
+        context = self.read_context()
+        self.assertEqual(len(context),
+                         max(self.slice(regno).stop
+                             for regno in range(len(self.registers))))
+        for regno, info in enumerate(self.registers):
+            if 'container-regs' in info:
+                continue
+            self.assertEqual(
+                gdbremote.encode_hex(context[self.slice(regno)]),
+                self.request('p%x' % regno), info['name'])
+
+    def test_round_trip(self):
+        context = bytearray(self.read_context())
+        rax = self.slice(self.numbers()['rax'])
+        xmm15 = self.slice(self.numbers()['xmm15'])
+        # Every byte the protocol needs escaped.
+        context[rax] = b'$#}*\x00\xff}}'
+        context[xmm15] = bytes(bytearray(range(0x20, 0x30)))
+        self.write_context(bytes(context))
+        self.assertEqual(self.read_context(), bytes(context))
+        stop, _ = self.resume('s')
+        self.assertEqual(stop.signal, signal.SIGTRAP, stop.data)
+        self.assertEqual(self.read_context()[rax], b'$#}*\x00\xff}}')
+        self.assertEqual(self.read_context()[xmm15],
+                         bytes(bytearray(range(0x20, 0x30))))
+
+    def numbers(self):
+        names = dict((info['name'], regno)
+                     for regno, info in enumerate(self.registers))
+        if 'rax' not in names or 'xmm15' not in names:
+            self.skipTest('not an x86_64 inferior')
+        return names
+
+
+class BinaryRegisterContextTest(RegisterContextTest):
+    binary = True
@@ -0,0 +1,94 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import xml.etree.ElementTree as ElementTree
+
+import gdbremote
+
+# qRegisterInfo keys and their target.xml counterparts; register lists are
+# hex in the former and decimal in the latter.
+ATTRIBUTES = (('name', 'name'), ('alt-name', 'altname'),
+              ('bitsize', 'bitsize'), ('offset', 'offset'),
+              ('encoding', 'encoding'), ('format', 'format'),
+              ('gcc', 'gcc_regnum'), ('dwarf', 'dwarf_regnum'),
+              ('generic', 'generic'))
+LISTS = (('container-regs', 'value_regnums'),
+         ('invalidate-regs', 'invalidate_regnums'))
+
+
+class RegisterInfoTest(gdbremote.TestCase):
+    program = 'memory'
+
+    def setUp(self):
+        super(RegisterInfoTest, self).setUp()
+        self.run_to_stop()
+        self.registers = self.register_info()
+
+    def features(self):
+        """Every <reg> of target.xml and its includes, by register number,
+        along with the name of its group."""
+        target = ElementTree.fromstring(self.xfer_read('features',
+                                                       'target.xml'))
+        groups = dict((group.get('id'), group.get('name'))
+                      for group in target.iter('group'))
+        registers = {}
+        for include in target.iter('include'):
+            feature = ElementTree.fromstring(
+                self.xfer_read('features', include.get('href')))
+            for reg in feature.iter('reg'):
+                registers[int(reg.get('regnum'))] = (reg, groups.get(
+                    reg.get('group_id')))
+        return registers
+
+    def test_count(self):
+        self.assertGreater(len(self.registers), 0)
+        self.assertEqual(self.request('qRegisterInfo%x' %
+                                      len(self.registers))[:1], b'E')
+
+    def test_features(self):
+        # Both descriptions come from the same tables and must agree.
+        features = self.features()
+        self.assertEqual(sorted(features), list(range(len(self.registers))))
+        for regno, info in enumerate(self.registers):
+            reg, group = features[regno]
+            self.assertEqual(group, info.get('set'), info['name'])
+            for key, attribute in ATTRIBUTES:
+                self.assertEqual(reg.get(attribute), info.get(key),
+                                 '%s %s' % (info['name'], key))
+            for key, attribute in LISTS:
+                expected = None
+                if key in info:
+                    expected = ','.join(str(int(n, 16))
+                                        for n in info[key].split(','))
+                self.assertEqual(reg.get(attribute), expected,
+                                 '%s %s' % (info['name'], key))
+
+    def test_read_every_register(self):
+        # Every number qRegisterInfo knows about can be read at its size.
+        for regno, info in enumerate(self.registers):
+            reply = self.request('p%x' % regno)
+            self.assertEqual(len(reply), int(info['bitsize']) // 4,
+                             '%s %s' % (info['name'], reply))
+        self.assertEqual(self.request('p%x' % len(self.registers))[:1], b'E')
+        self.assertEqual(self.request('P%x=00' % len(self.registers))[:1],
+                         b'E')
+
+    def test_subregisters(self):
+        # Registers that live inside another one read as its low bytes.
+        for regno, info in enumerate(self.registers):
+            if 'container-regs' not in info:
+                continue
+            container = int(info['container-regs'].split(',')[0], 16)
+            value = gdbremote.decode_hex(self.request('p%x' % regno))
+            whole = gdbremote.decode_hex(self.request('p%x' % container))
+            if info['name'] in ('ah', 'bh', 'ch', 'dh'):
+                self.assertEqual(value, whole[1:2], info['name'])
+            else:
+                self.assertEqual(value, whole[:len(value)], info['name'])
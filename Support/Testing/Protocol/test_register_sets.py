@@ -0,0 +1,99 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import signal
+
+import gdbremote
+
+
+class RegisterSetsTest(gdbremote.TestCase):
+    program = 'memory'
+
+    def setUp(self):
+        super(RegisterSetsTest, self).setUp()
+        self.run_to_stop()
+        self.registers = self.register_info()
+        self.numbers = dict((info['name'], regno)
+                            for regno, info in enumerate(self.registers))
+
+    def register(self, name):
+        if name not in self.numbers:
+            self.skipTest('no %s register' % name)
+        return self.numbers[name]
+
+    def read_register(self, name):
+        reply = self.request('p%x' % self.register(name))
+        self.assertNotEqual(reply[:1], b'E', reply)
+        return gdbremote.decode_hex(reply)
+
+    def write_register(self, name, value):
+        self.assertOK(self.request('P%x=%s' % (
+            self.register(name), gdbremote.encode_hex(value).decode())))
+
+    def value(self, name, seed):
+        size = int(self.registers[self.register(name)]['bitsize']) // 8
+        return bytes(bytearray((seed + n * 13) & 0xff for n in range(size)))
+
+    def test_read_vector_first(self):
+        # Nothing but a vector register was read since the stop.
+        xmm = self.read_register('xmm15')
+        context = self.request('g')
+        offset = int(self.registers[self.register('xmm15')]['offset']) * 2
+        self.assertEqual(context[offset:offset + len(xmm) * 2],
+                         gdbremote.encode_hex(xmm))
+
+    def test_write_vector(self):
+        rax = self.read_register('rax')
+        mxcsr = self.read_register('mxcsr')
+        value = self.value('xmm15', 1)
+        self.write_register('xmm15', value)
+        self.assertEqual(self.read_register('xmm15'), value)
+        # Other sets, and the rest of this one, are left alone.
+        self.assertEqual(self.read_register('rax'), rax)
+        self.assertEqual(self.read_register('mxcsr'), mxcsr)
+
+    def test_write_general_purpose(self):
+        xmm = self.read_register('xmm15')
+        value = self.value('rax', 2)
+        self.write_register('rax', value)
+        self.assertEqual(self.read_register('rax'), value)
+        self.assertEqual(self.read_register('xmm15'), xmm)
+
+    def test_write_on_step(self):
+        # Both sets are written back to the thread before it runs, and read
+        # again after it stops; one instruction won't touch xmm15.
+        value = self.value('xmm15', 3)
+        self.write_register('xmm15', value)
+        self.write_register('fctrl', b'\x7f\x02')
+        stop, _ = self.resume('s')
+        self.assertEqual(stop.signal, signal.SIGTRAP, stop.data)
+        self.assertEqual(self.read_register('xmm15'), value)
+        self.assertEqual(self.read_register('fctrl'), b'\x7f\x02')
+
+    def test_write_extended_state(self):
+        # The upper half of ymm15 lives in the XSAVE area; it is written back
+        # along with the rest of the state.
+        value = self.value('ymm15', 4)
+        self.write_register('ymm15', value)
+        stop, _ = self.resume('s')
+        self.assertEqual(stop.signal, signal.SIGTRAP, stop.data)
+        self.assertEqual(self.read_register('ymm15'), value)
+        self.assertEqual(self.read_register('xmm15'), value[:16])
+
+    def test_write_lower_half(self):
+        # Writing xmm15 leaves the upper half of ymm15 in place.
+        value = self.value('ymm15', 5)
+        self.write_register('ymm15', value)
+        self.resume('s')
+        lower = self.value('xmm15', 6)
+        self.write_register('xmm15', lower)
+        self.assertEqual(self.read_register('ymm15'), lower + value[16:])
+        self.resume('s')
+        self.assertEqual(self.read_register('ymm15'), lower + value[16:])
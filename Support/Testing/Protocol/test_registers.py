@@ -0,0 +1,76 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import signal
+
+import gdbremote
+
+
+class RegistersTest(gdbremote.TestCase):
+    program = 'memory'
+
+    def setUp(self):
+        super(RegistersTest, self).setUp()
+        self.values = self.run_to_stop()
+        self.registers = self.register_info()
+        self.pc = self.generic_register('pc')
+
+    def read_register(self, regno):
+        reply = self.request('p%x' % regno)
+        self.assertNotEqual(reply[:1], b'E', reply)
+        return reply
+
+    def write_register(self, regno, value):
+        self.assertOK(self.request('P%x=%s' % (regno, value.decode())))
+
+    def encode(self, regno, value):
+        size = int(self.registers[regno]['bitsize']) // 8
+        return gdbremote.encode_hex(value.to_bytes(size, 'little'))
+
+    def test_read(self):
+        # g holds the registers at their offsets.
+        context = self.request('g')
+        for regno, info in enumerate(self.registers):
+            offset = int(info['offset']) * 2
+            size = int(info['bitsize']) // 4
+            if 'container-regs' in info or offset + size > len(context):
+                continue
+            self.assertEqual(context[offset:offset + size],
+                             self.read_register(regno), info['name'])
+
+    def test_write(self):
+        original = self.read_register(self.pc)
+        self.write_register(self.pc, self.encode(self.pc, 0x1234))
+        self.assertEqual(self.read_register(self.pc),
+                         self.encode(self.pc, 0x1234))
+        self.write_register(self.pc, original)
+        self.assertEqual(self.read_register(self.pc), original)
+        # Nothing else was written back, the inferior stops again normally.
+        self.run_to_stop()
+
+    def test_write_on_resume(self):
+        # The write reaches the thread when it resumes, it then faults at the
+        # address we wrote and the stop shows the new state.
+        self.write_register(self.pc, self.encode(self.pc, 0))
+        stop, _ = self.resume()
+        self.assertEqual(stop.signal, signal.SIGSEGV, stop.data)
+        self.assertEqual(gdbremote.decode_integer(self.read_register(self.pc)),
+                         0)
+        self.assertEqual(stop.pairs['%02x' % self.pc],
+                         self.read_register(self.pc).decode())
+
+    def test_step(self):
+        # Registers are read again after each stop.
+        before = self.read_register(self.pc)
+        stop, _ = self.resume('s')
+        self.assertEqual(stop.signal, signal.SIGTRAP, stop.data)
+        after = self.read_register(self.pc)
+        self.assertNotEqual(after, before)
+        self.assertEqual(stop.pairs['%02x' % self.pc], after.decode())
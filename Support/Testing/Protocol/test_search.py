@@ -0,0 +1,68 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import gdbremote
+
+NEEDLE = b'ds2-needle-0123456789'
+
+
+class SearchTest(gdbremote.TestCase):
+    program = 'memory'
+
+    def setUp(self):
+        super(SearchTest, self).setUp()
+        self.values = self.run_to_stop()
+        self.buffer = self.values['buffer']
+        self.needle = self.values['needle']
+
+    def search(self, address, length, pattern):
+        """The address of the first match, None if there are none."""
+        reply = self.request(('qSearch:memory:%x;%x;' % (address, length))
+                             .encode('ascii') + gdbremote.escape(pattern))
+        if reply == b'0':
+            return None
+        found, _, location = reply.partition(b',')
+        self.assertEqual(found, b'1', reply)
+        return int(location, 16)
+
+    def test_found(self):
+        self.assertEqual(self.search(self.buffer, self.values['size'], NEEDLE),
+                         self.needle)
+
+    def test_not_found(self):
+        self.assertIsNone(self.search(self.buffer, self.values['size'],
+                                      b'ds2-needle-9876543210'))
+
+    def test_range(self):
+        # The match must fit entirely in the range.
+        length = len(NEEDLE)
+        self.assertIsNone(self.search(self.needle, length - 1, NEEDLE))
+        self.assertIsNone(self.search(self.needle + 1, length - 1, NEEDLE))
+        self.assertEqual(self.search(self.needle, length, NEEDLE), self.needle)
+
+    def test_binary_pattern(self):
+        # Straddles two pages.
+        pattern = b'\x00}$#*\x00\xff'
+        address = self.buffer + 11 * self.values['page'] - 3
+        self.write_memory(address, pattern)
+        self.assertEqual(self.search(self.buffer, self.values['size'], pattern),
+                         address)
+
+    def test_backward(self):
+        word = int.from_bytes(NEEDLE[:4], 'little')
+        reply = self.request('t%x:%x,ffffffff' % (self.needle + 0x100, word))
+        self.assertEqual(int(reply, 16), self.needle)
+
+    def test_backward_mask(self):
+        # Only the first two bytes have to match; "ds" doesn't appear in the
+        # pattern around the needle.
+        word = int.from_bytes(b'ds\xaa\xbb', 'little')
+        reply = self.request('t%x:%x,ffff' % (self.needle + 0x100, word))
+        self.assertEqual(int(reply, 16), self.needle)
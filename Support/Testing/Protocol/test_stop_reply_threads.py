@@ -0,0 +1,76 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import json
+import os
+import signal
+
+import gdbremote
+
+
+class StopReplyThreadsTest(gdbremote.TestCase):
+    program = 'threads'
+
+    def setUp(self):
+        super(StopReplyThreadsTest, self).setUp()
+        self.pc = self.generic_register('pc')
+
+    def stop(self):
+        stop, _ = self.resume()
+        self.assertEqual(stop.signal, signal.SIGUSR1, stop.data)
+        self.values = self.reported()
+        return stop
+
+    def tasks(self):
+        return set(int(tid) for tid in
+                   os.listdir('/proc/%d/task' % self.values['pid']))
+
+    def test_not_listed(self):
+        stop = self.stop()
+        for key in ('threads', 'thread-pcs', 'jstopinfo'):
+            self.assertNotIn(key, stop.pairs)
+
+    def test_thread_pcs(self):
+        self.assertOK(self.request('QListThreadsInStopReply'))
+        for _ in range(2):
+            stop = self.stop()
+            tids = [int(tid, 16) for tid in stop.pairs['threads'].split(',')]
+            pcs = [int(pc, 16) for pc in stop.pairs['thread-pcs'].split(',')]
+            self.assertEqual(set(tids), self.tasks())
+            self.assertEqual(len(pcs), len(tids))
+            # No need to ask for them.
+            for tid, pc in zip(tids, pcs):
+                reply = self.request('p%x;thread:%x;' % (self.pc, tid))
+                self.assertEqual(gdbremote.decode_integer(reply), pc)
+
+    def test_jstopinfo(self):
+        self.assertOK(self.request('QListThreadsInStopReply'))
+        stop = self.stop()
+        # Only the thread that stopped for a reason is described, the
+        # others are in the thread list.
+        info = json.loads(gdbremote.decode_hex(stop.pairs['jstopinfo'])
+                          .decode())
+        self.assertEqual([thread['tid'] for thread in info], [stop.thread()])
+        self.assertEqual(info[0]['reason'], 'signal')
+        self.assertEqual(info[0]['signal'], signal.SIGUSR1)
+        tids = [int(tid, 16) for tid in stop.pairs['threads'].split(',')]
+        self.assertEqual(set(tids), self.tasks())
+
+    def test_thread_stop_info(self):
+        # Replies about the other threads describe the same stop.
+        self.assertOK(self.request('QListThreadsInStopReply'))
+        stop = self.stop()
+        for tid in stop.pairs['threads'].split(','):
+            reply = gdbremote.StopReply(self.request('qThreadStopInfo' + tid))
+            self.assertEqual(reply.pairs['threads'], stop.pairs['threads'])
+            info = json.loads(gdbremote.decode_hex(reply.pairs['jstopinfo'])
+                              .decode())
+            self.assertEqual([thread['tid'] for thread in info],
+                             [stop.thread()])
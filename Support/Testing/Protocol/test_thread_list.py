@@ -0,0 +1,64 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import os
+
+import gdbremote
+
+# Enough threads for the list not to fit in one packet.
+THREADS = 4000
+MAX_PACKET_SIZE = 0x3fff
+
+
+class ThreadListTest(gdbremote.TestCase):
+    program = 'threads'
+    arguments = (str(THREADS),)
+
+    def setUp(self):
+        super(ThreadListTest, self).setUp()
+        self.values = self.run_to_stop()
+
+    def thread_list(self):
+        """The thread ids and the replies they came in."""
+        tids = []
+        replies = []
+        reply = self.request('qfThreadInfo')
+        while reply != b'l':
+            self.assertEqual(reply[:1], b'm', reply)
+            self.assertLessEqual(len(reply), MAX_PACKET_SIZE)
+            tids.extend(int(tid, 16) for tid in reply[1:].split(b','))
+            replies.append(reply)
+            reply = self.request('qsThreadInfo')
+        return tids, replies
+
+    def tasks(self):
+        return set(int(tid) for tid in
+                   os.listdir('/proc/%d/task' % self.values['pid']))
+
+    def test_list(self):
+        tids, replies = self.thread_list()
+        self.assertEqual(len(tids), THREADS + 1)
+        self.assertEqual(set(tids), self.tasks())
+        self.assertGreater(len(replies), 1)
+
+    def test_restart(self):
+        # qfThreadInfo starts over, in the middle of a list or after it.
+        first = self.request('qfThreadInfo')
+        self.request('qfThreadInfo')
+        tids, _ = self.thread_list()
+        self.assertEqual(tids[:first.count(b',') + 1],
+                         [int(tid, 16) for tid in first[1:].split(b',')])
+        self.assertEqual(self.thread_list()[0], tids)
+
+    def test_next_stop(self):
+        self.values = self.run_to_stop()
+        tids, _ = self.thread_list()
+        self.assertEqual(len(tids), self.values['threads'] + 1)
+        self.assertEqual(set(tids), self.tasks())
@@ -0,0 +1,58 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import signal
+
+import gdbremote
+
+
+class ThreadNamesTest(gdbremote.TestCase):
+    program = 'threads'
+
+    def stop(self):
+        stop, _ = self.resume()
+        self.assertEqual(stop.signal, signal.SIGUSR1, stop.data)
+        self.values = self.reported()
+        return stop
+
+    def comm(self, tid):
+        with open('/proc/%d/task/%d/comm' % (self.values['pid'], tid)) as f:
+            return f.read().rstrip('\n')
+
+    def names(self):
+        """Thread names from jThreadsInfo, checked against qThreadStopInfo
+        and /proc, in thread creation order."""
+        names = []
+        for thread in self.request_json('jThreadsInfo'):
+            reply = gdbremote.StopReply(
+                self.request('qThreadStopInfo%x' % thread['tid']))
+            self.assertEqual(reply.pairs.get('name'), thread['name'])
+            self.assertEqual(thread['name'], self.comm(thread['tid']))
+            names.append(thread['name'])
+        return names
+
+    def test_names(self):
+        stop = self.stop()
+        self.assertEqual(stop.pairs['name'], 'threads')
+        self.assertEqual(self.names(),
+                         ['threads'] + ['worker-%d' % n
+                                        for n in range(self.values['threads'])])
+        # Asking again gives the same answer.
+        self.assertEqual(self.names(), self.names())
+
+    def test_rename(self):
+        # A name read at one stop is read again after the thread ran.
+        self.stop()
+        count = self.values['threads']
+        self.names()
+        self.stop()
+        self.assertEqual(self.names(),
+                         ['threads', 'renamed'] +
+                         ['worker-%d' % n for n in range(1, count + 4)])
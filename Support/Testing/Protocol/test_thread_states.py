@@ -0,0 +1,68 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import os
+import signal
+
+import gdbremote
+
+
+class ThreadStatesTest(gdbremote.TestCase):
+    program = 'threads'
+
+    def setUp(self):
+        super(ThreadStatesTest, self).setUp()
+        self.values = self.run_to_stop()
+
+    def tids(self):
+        tids = []
+        reply = self.request('qfThreadInfo')
+        while reply != b'l':
+            tids.extend(int(tid, 16) for tid in reply[1:].split(b','))
+            reply = self.request('qsThreadInfo')
+        return tids
+
+    def kernel_state(self, tid):
+        with open('/proc/%d/task/%d/stat' % (self.values['pid'], tid)) as f:
+            return f.read().rpartition(')')[2].split()[0]
+
+    def assertAllStopped(self):
+        tids = self.tids()
+        for tid in tids:
+            self.assertEqual(self.kernel_state(tid), 't', tid)
+            reply = self.request('qThreadStopInfo%x' % tid)
+            self.assertEqual(reply[:1], b'T', reply)
+            self.assertEqual(gdbremote.StopReply(reply).thread(), tid)
+        return tids
+
+    def test_stopped(self):
+        self.assertEqual(len(self.assertAllStopped()),
+                         self.values['threads'] + 1)
+        self.values = self.run_to_stop()
+        self.assertEqual(len(self.assertAllStopped()),
+                         self.values['threads'] + 1)
+
+    def test_exited(self):
+        before = self.tids()
+        self.run_to_stop()
+        self.run_to_stop()
+        self.assertEqual(self.assertAllStopped(), [self.values['pid']])
+        for tid in before[1:]:
+            self.assertEqual(self.request('qThreadStopInfo%x' % tid)[:1],
+                             b'E')
+
+    def test_step_one_thread(self):
+        # The others stay stopped and are still known; the workers sit in a
+        # system call that a step would wait for, so step the main thread.
+        tids = self.tids()
+        stop, _ = self.resume('vCont;s:%x' % self.values['pid'])
+        self.assertEqual(stop.signal, signal.SIGTRAP, stop.data)
+        self.assertEqual(stop.thread(), self.values['pid'])
+        self.assertEqual(self.assertAllStopped(), tids)
@@ -0,0 +1,75 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import json
+import signal
+
+import gdbremote
+
+
+class ThreadsInfoTest(gdbremote.TestCase):
+    program = 'threads'
+
+    def setUp(self):
+        super(ThreadsInfoTest, self).setUp()
+        self.assertOK(self.request('QListThreadsInStopReply'))
+
+    def stop(self):
+        stop, _ = self.resume()
+        self.assertEqual(stop.signal, signal.SIGUSR1, stop.data)
+        self.values = self.reported()
+        return stop
+
+    def test_registers(self):
+        self.stop()
+        threads = self.request_json('jThreadsInfo')
+        self.assertEqual(len(threads), self.values['threads'] + 1)
+        for thread in threads:
+            for regno, value in thread['registers'].items():
+                reply = self.request('p%x;thread:%x;' % (int(regno),
+                                                         thread['tid']))
+                self.assertEqual(reply, value.encode(), regno)
+
+    def test_same_stop(self):
+        # Every way of asking describes the same stop.
+        stop = self.stop()
+        threads = self.request_json('jThreadsInfo')
+        jstopinfo = json.loads(gdbremote.decode_hex(stop.pairs['jstopinfo'])
+                               .decode())
+        self.assertEqual([thread['tid'] for thread in threads
+                          if 'reason' in thread],
+                         [thread['tid'] for thread in jstopinfo])
+        self.assertEqual(
+            [int(tid, 16) for tid in stop.pairs['threads'].split(',')],
+            [thread['tid'] for thread in threads])
+
+        for thread in threads:
+            reply = gdbremote.StopReply(
+                self.request('qThreadStopInfo%x' % thread['tid']))
+            self.assertEqual(reply.thread(), thread['tid'])
+            self.assertEqual(reply.signal, thread.get('signal', 0))
+            self.assertEqual(reply.pairs.get('reason'), thread.get('reason'))
+            for regno, value in reply.registers().items():
+                self.assertEqual(thread['registers'][str(regno)], value)
+
+        stopped = [thread for thread in threads
+                   if thread['tid'] == stop.thread()][0]
+        self.assertEqual(stopped['signal'], signal.SIGUSR1)
+        for regno, value in stop.registers().items():
+            self.assertEqual(stopped['registers'][str(regno)], value)
+
+    def test_next_stop(self):
+        self.stop()
+        before = self.request_json('jThreadsInfo')
+        self.assertEqual(self.request_json('jThreadsInfo'), before)
+        self.stop()
+        after = self.request_json('jThreadsInfo')
+        self.assertEqual(len(after), self.values['threads'] + 1)
+        self.assertNotEqual(after, before)
@@ -0,0 +1,74 @@
+##
+## Copyright (c) 2014-present, Facebook, Inc.
+## All rights reserved.
+##
+## This source code is licensed under the University of Illinois/NCSA Open
+## Source License found in the LICENSE file in the root directory of this
+## source tree. An additional grant of patent rights can be found in the
+## PATENTS file in the same directory.
+##
+
+import xml.etree.ElementTree as ElementTree
+
+import gdbremote
+
+FEATURES = 'General Purpose Registers'
+
+
+class XferTest(gdbremote.TestCase):
+    program = 'memory'
+
+    def setUp(self):
+        super(XferTest, self).setUp()
+        self.run_to_stop()
+
+    def test_slices(self):
+        # Small slices put back together make the same document, for each
+        # kind of document we generate.
+        for object, annex in (('features', 'target.xml'),
+                              ('features', FEATURES),
+                              ('auxv', ''),
+                              ('libraries-svr4', ''),
+                              ('threads', '')):
+            whole = self.xfer_read(object, annex)
+            self.assertEqual(self.xfer_read(object, annex, chunk=0x61), whole,
+                             object)
+
+    def test_past_end(self):
+        whole = self.xfer_read('features', FEATURES)
+        reply = self.request('qXfer:features:read:%s:%x,10' %
+                             (FEATURES, len(whole)))
+        self.assertEqual(reply, b'l')
+        reply = self.request('qXfer:features:read:%s:%x,10' %
+                             (FEATURES, len(whole) - 4))
+        self.assertEqual(reply, b'l' + gdbremote.escape(whole[-4:]))
+
+    def test_interleaved(self):
+        # Reading one document doesn't disturb the other ones being read.
+        first = self.xfer_read('features', FEATURES)
+        second = self.xfer_read('auxv', '')
+        reply = self.request('qXfer:features:read:%s:0,100' % FEATURES)
+        self.assertEqual(reply[:1], b'm')
+        self.assertEqual(self.xfer_read('auxv', '', chunk=0x30), second)
+        reply = self.request('qXfer:features:read:%s:100,3000' % FEATURES)
+        self.assertEqual(gdbremote.unescape(reply[1:]), first[0x100:])
+
+
+class XferThreadsTest(gdbremote.TestCase):
+    program = 'threads'
+
+    def threads(self, chunk=0x3000):
+        document = ElementTree.fromstring(self.xfer_read('threads', '',
+                                                         chunk=chunk))
+        return [thread.get('id') for thread in document.iter('thread')]
+
+    def test_new_stop(self):
+        # A document is regenerated at the next stop, even if it was being
+        # read at the time.
+        values = self.run_to_stop()
+        self.assertEqual(len(self.threads(chunk=0x40)), values['threads'] + 1)
+        self.request('qXfer:threads:read::0,40')
+        values = self.run_to_stop()
+        self.assertEqual(len(self.threads(chunk=0x40)), values['threads'] + 1)
+        self.run_to_stop()
+        self.assertEqual(len(self.threads()), 1)
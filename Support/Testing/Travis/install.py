@@ -92,6 +92,9 @@ if os.getenv('GDB_TESTS') != None:
     dist_packages.append('dejagnu')
     dist_packages.append('gdb')
 
+if os.getenv('PROTOCOL_TESTS') != None:
+    dist_packages.append('python3')
+
 if os.getenv('COVERAGE') == '1':
     dist_packages.append('python-pip')
     dist_packages.append('python-yaml')
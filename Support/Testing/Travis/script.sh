@@ -131,3 +131,7 @@ fi
 if [[ -n "${GDB_TESTS-}" ]]; then
   "$top/Support/Scripts/run-gdb-tests.sh"
 fi
+
+if [[ -n "${PROTOCOL_TESTS-}" ]]; then
+  "$top/Support/Scripts/run-protocol-tests.sh"
+fi
@@ -10,6 +10,7 @@
 
 #include "Context.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <sstream>
@@ -462,6 +463,7 @@ static void GenerateProlog1(FILE *fp, Context const &ctx) {
   fprintf(fp, "using ds2::Architecture::GDBVectorUnionField;\n");
   fprintf(fp, "using ds2::Architecture::GDBFeature;\n");
   fprintf(fp, "using ds2::Architecture::GDBFeatureEntry;\n");
+  fprintf(fp, "using ds2::Architecture::LLDBRegisterInfo;\n");
   fprintf(fp, "using ds2::Architecture::LLDBRegisterSet;\n\n");
 
   fprintf(fp, "#if defined(ENDIAN_BIG)\n");
@@ -623,6 +625,144 @@ static void GenerateLLDBRegisterSets(FILE *fp, Context const &ctx) {
   fprintf(fp, "};\n\n");
 }
 
+//
+// FNV-1a hash of a register name; it must match RegisterNameHash in
+// DebugServer2/Architecture/RegisterLayout.h.
+//
+static uint32_t RegisterNameHash(std::string const &name, uint32_t seed) {
+  uint32_t hash = 2166136261u ^ seed;
+  for (char c : name) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+//
+// Names LLDB may look registers up with, in the order a linear search
+// through the register sets would find them, along with the position of
+// their register in lldb_reg_index, which is what lookups index.
+//
+static void
+CollectLLDBNames(Context const &ctx,
+                 std::vector<std::pair<std::string, ssize_t>> &names) {
+  std::set<std::string> seen;
+  ssize_t index = 0;
+  for (auto def : ctx.LLDBDefs) {
+    for (auto regset : def->RegisterSets) {
+      for (auto &reg : *regset) {
+        for (auto const &name : {reg->LLDBName, reg->Name}) {
+          if (!name.empty() && seen.insert(name).second) {
+            names.push_back(std::make_pair(name, index));
+          }
+        }
+        index++;
+      }
+    }
+  }
+}
+
+//
+// Builds a minimal perfect hash of the names using hash and displace: the
+// names are spread into buckets by their unseeded hash, then each bucket,
+// largest first, gets the first seed that sends all its names to free
+// slots.
+//
+static bool
+BuildLLDBNameHash(std::vector<std::pair<std::string, ssize_t>> const &names,
+                  std::vector<uint32_t> &seeds, std::vector<ssize_t> &slots) {
+  size_t nslots = names.size();
+  size_t nbuckets = (nslots + 3) / 4;
+
+  std::vector<std::vector<size_t>> buckets(nbuckets);
+  for (size_t n = 0; n < nslots; n++) {
+    buckets[RegisterNameHash(names[n].first, 0) % nbuckets].push_back(n);
+  }
+
+  std::vector<size_t> order;
+  for (size_t n = 0; n < nbuckets; n++) {
+    order.push_back(n);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return buckets[a].size() > buckets[b].size();
+  });
+
+  seeds.assign(nbuckets, 0);
+  slots.assign(nslots, -1);
+
+  for (auto b : order) {
+    if (buckets[b].empty())
+      continue;
+
+    uint32_t seed;
+    for (seed = 1; seed < (1u << 24); seed++) {
+      std::vector<size_t> placed;
+      for (auto n : buckets[b]) {
+        size_t slot = RegisterNameHash(names[n].first, seed) % nslots;
+        if (slots[slot] != -1 ||
+            std::find(placed.begin(), placed.end(), slot) != placed.end())
+          break;
+        placed.push_back(slot);
+      }
+
+      if (placed.size() == buckets[b].size()) {
+        for (size_t n = 0; n < placed.size(); n++) {
+          slots[placed[n]] = names[buckets[b][n]].second;
+        }
+        break;
+      }
+    }
+
+    if (seed == (1u << 24))
+      return false;
+    seeds[b] = seed;
+  }
+
+  return true;
+}
+
+static void GenerateLLDBLookupTables(FILE *fp, Context const &ctx) {
+  if (ctx.LLDBDefs.empty())
+    return;
+
+  fprintf(fp, "//\n");
+  fprintf(fp, "// LLDB Register Lookup Tables\n");
+  fprintf(fp, "//\n\n");
+
+  fprintf(fp, "constexpr LLDBRegisterInfo lldb_reg_index[] = {\n");
+  for (auto def : ctx.LLDBDefs) {
+    for (auto regset : def->RegisterSets) {
+      for (auto &reg : *regset) {
+        fprintf(fp, "%*s{%s, &reg_def_%s},\n", 4, "",
+                QuoteOrNull(def->Description).c_str(), reg->CName.c_str());
+      }
+    }
+  }
+  fprintf(fp, "};\n\n");
+
+  std::vector<std::pair<std::string, ssize_t>> names;
+  std::vector<uint32_t> seeds;
+  std::vector<ssize_t> slots;
+
+  CollectLLDBNames(ctx, names);
+  if (!BuildLLDBNameHash(names, seeds, slots)) {
+    fprintf(stderr, "error: cannot build a perfect hash of register names\n");
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(fp, "constexpr uint32_t lldb_reg_name_seeds[] = {\n");
+  for (auto seed : seeds) {
+    fprintf(fp, "%*s%u,\n", 4, "", seed);
+  }
+  fprintf(fp, "};\n\n");
+
+  fprintf(fp, "constexpr int32_t lldb_reg_name_slots[] = {\n");
+  for (auto slot : slots) {
+    fprintf(fp, "%*s%zd,\n", 4, "", slot);
+  }
+  fprintf(fp, "};\n\n");
+}
+
 static void GenerateLLDBSubSets(FILE *fp, Context const &ctx) {
   if (!ctx.HasInvalidatedOrContainerSets)
     return;
@@ -929,8 +1069,21 @@ static void GenerateLLDBDescriptor(FILE *fp, Context const &ctx) {
   if (ctx.LLDBDefs.empty())
     return;
 
-  fprintf(fp, "LLDBDescriptor const LLDB = { %zu, lldb_reg_sets };\n",
-          ctx.LLDBDefs.count());
+  size_t count = 0;
+  for (auto def : ctx.LLDBDefs) {
+    for (auto regset : def->RegisterSets) {
+      count += std::distance(regset->begin(), regset->end());
+    }
+  }
+
+  std::vector<std::pair<std::string, ssize_t>> names;
+  CollectLLDBNames(ctx, names);
+
+  fprintf(fp,
+          "LLDBDescriptor const LLDB = { %zu, lldb_reg_sets, %zu, "
+          "lldb_reg_index, %zu, lldb_reg_name_seeds, %zu, "
+          "lldb_reg_name_slots };\n",
+          ctx.LLDBDefs.count(), count, (names.size() + 3) / 4, names.size());
 }
 
 static void GenerateGDBDescriptor(FILE *fp, Context const &ctx) {
@@ -1194,6 +1347,7 @@ int main(int argc, char *const *argv) {
     GenerateForwardDecls(fp, ctx);
 
     GenerateLLDBRegisterSets(fp, ctx);
+    GenerateLLDBLookupTables(fp, ctx);
     GenerateGDBFeatures(fp, ctx);
 
     GenerateLLDBSubSets(fp, ctx);